@@ -4,9 +4,37 @@ uniform dvec2 fractalTL;
 uniform double xScale;
 uniform double yScale;
 uniform int iterations;
+uniform int simWidth;
+
+layout(std430, binding = 4) buffer InteriorStats
+{
+	uint skippedPixels;
+};
 
 out vec4 pixelColor;
 
+bool inMainCardioid(dvec2 fractalCoord) {
+  // This algorithm was taken from the Wikipedia Mandelbrot set page.
+  double imag_squared = fractalCoord.y * fractalCoord.y;
+  double q = (fractalCoord.x - 0.25);
+  q = q * q + imag_squared;
+  return q * (q + (fractalCoord.x - 0.25)) < (imag_squared * 0.25);
+}
+
+bool inOrder2Bulb(dvec2 fractalCoord)
+{
+  double tmp = fractalCoord.x + 1;
+  tmp = tmp * tmp;
+  return (tmp + (fractalCoord.y * fractalCoord.y)) < (1.0 / 16.0);
+}
+
+bool isInterior(dvec2 id)
+{
+	dvec2 scaledOffset = dvec2(id.x * xScale, id.y * yScale );
+	dvec2 fractalCoord = dvec2(fractalTL + scaledOffset);
+	return inMainCardioid(fractalCoord) || inOrder2Bulb(fractalCoord);
+}
+
 float map(float value, float min1, float max1, float min2, float max2) {
   return min2 + (value - min1) * (max2 - min2) / (max1 - min1);
 }
@@ -21,6 +49,24 @@ void main()
     dvec2 z = dvec2(0.0, 0.0);
 	dvec2 c = fractalCoord;
 
+	// Points in the main cardioid or order 2 bulb never escape
+	if (inMainCardioid(c) || inOrder2Bulb(c))
+	{
+		// Only the first pixel of an interior run in a row counts, for the whole run, so the
+		// counter sees one atomic per run instead of one per pixel
+		if (id.x < 1.0 || !isInterior(id - dvec2(1.0, 0.0)))
+		{
+			uint run = 1u;
+			for (dvec2 next = id + dvec2(1.0, 0.0); next.x < simWidth && isInterior(next); next.x += 1.0)
+			{
+				run++;
+			}
+			atomicAdd(skippedPixels, run);
+		}
+		pixelColor = vec4(iterations, 0.0, 0.0, 1.0);
+		return;
+	}
+
 	int n = 0;
 	for (; n < iterations && dot(z, z) < 4.0; n++)
 	{
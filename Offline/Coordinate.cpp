@@ -0,0 +1,129 @@
+﻿#include "Coordinate.h"
+
+#include <cctype>
+#include <cmath>
+
+namespace Se::Offline
+{
+namespace
+{
+// hi + lo == a + b exactly
+auto TwoSum(double a, double b) -> Coordinate
+{
+	Coordinate result;
+	result.Hi = a + b;
+	const double b1 = result.Hi - a;
+	result.Lo = (a - (result.Hi - b1)) + (b - b1);
+	return result;
+}
+
+auto Normalised(double hi, double lo) -> Coordinate
+{
+	Coordinate result;
+	result.Hi = hi + lo;
+	result.Lo = lo - (result.Hi - hi);
+	return result;
+}
+
+auto Add(const Coordinate& a, const Coordinate& b) -> Coordinate
+{
+	const auto sum = TwoSum(a.Hi, b.Hi);
+	return Normalised(sum.Hi, sum.Lo + a.Lo + b.Lo);
+}
+
+auto Multiply(const Coordinate& a, double b) -> Coordinate
+{
+	const double hi = a.Hi * b;
+	const double error = std::fma(a.Hi, b, -hi);
+	return Normalised(hi, error + a.Lo * b);
+}
+
+auto Divide(const Coordinate& a, double b) -> Coordinate
+{
+	// One long division step on the remainder recovers the digits the first quotient rounds off
+	const double first = a.Hi / b;
+	const auto product = Multiply(Coordinate(first), b);
+	const auto remainder = Add(a, Coordinate(-product.Hi) + -product.Lo);
+	return Normalised(first, remainder.Hi / b);
+}
+}
+
+Coordinate::Coordinate(double value) :
+	Hi(value)
+{
+}
+
+auto Coordinate::Parse(const std::string& text) -> std::optional<Coordinate>
+{
+	size_t i = 0;
+	bool negative = false;
+	if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+	{
+		negative = text[i++] == '-';
+	}
+
+	// Digit by digit in double-double, so the digits past double's 17 still count
+	Coordinate value;
+	int scale = 0;
+	int digits = 0;
+	bool point = false;
+	for (; i < text.size(); i++)
+	{
+		const char c = text[i];
+		if (c == '.' && !point)
+		{
+			point = true;
+			continue;
+		}
+		if (!std::isdigit(static_cast<unsigned char>(c)))
+		{
+			break;
+		}
+		value = Add(Multiply(value, 10.0), Coordinate(c - '0'));
+		scale -= point ? 1 : 0;
+		digits++;
+	}
+	if (digits == 0)
+	{
+		return std::nullopt;
+	}
+
+	if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+	{
+		size_t end = 0;
+		try
+		{
+			scale += std::stoi(text.substr(i + 1), &end);
+		}
+		catch (const std::exception&)
+		{
+			return std::nullopt;
+		}
+		i += end + 1;
+	}
+	if (i != text.size())
+	{
+		return std::nullopt;
+	}
+
+	for (; scale > 0; scale--)
+	{
+		value = Multiply(value, 10.0);
+	}
+	for (; scale < 0; scale++)
+	{
+		value = Divide(value, 10.0);
+	}
+	return negative ? Coordinate(-value.Hi) + -value.Lo : value;
+}
+
+auto Coordinate::ToDouble() const -> double
+{
+	return Hi + Lo;
+}
+
+auto Coordinate::operator+(double offset) const -> Coordinate
+{
+	return Add(*this, Coordinate(offset));
+}
+}
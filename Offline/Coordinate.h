@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include <optional>
+#include <string>
+
+namespace Se::Offline
+{
+// A view coordinate as an unevaluated sum Hi + Lo, the offline counterpart of DoubleDouble without
+// the engine's vector types. Deep centres keep about 32 digits, as much as the kernels resolve.
+struct Coordinate
+{
+	double Hi = 0.0;
+	double Lo = 0.0;
+
+	Coordinate() = default;
+	Coordinate(double value);
+
+	// Decimal notation with an optional exponent, nothing for anything else
+	static auto Parse(const std::string& text) -> std::optional<Coordinate>;
+
+	auto ToDouble() const -> double;
+	auto operator+(double offset) const -> Coordinate;
+};
+}
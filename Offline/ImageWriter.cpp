@@ -0,0 +1,119 @@
+﻿#include "ImageWriter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "PngWriter.h"
+
+namespace Se::Offline
+{
+auto ImageWriter::Create(const Options& options) -> std::unique_ptr<ImageWriter>
+{
+	const auto format = options.OutputFormat();
+	if (format == "png")
+	{
+		return std::make_unique<PngWriter>(options.Compression);
+	}
+	if (format == "ppm")
+	{
+		return std::make_unique<PpmWriter>();
+	}
+	if (format == "rgba")
+	{
+		return std::make_unique<RgbaWriter>();
+	}
+	if (format == "iter")
+	{
+		return std::make_unique<IterationWriter>(IterationHeader::From(options));
+	}
+	return nullptr;
+}
+
+auto ImageWriter::Open(const std::string& path, const ImageInfo& info) -> bool
+{
+	_info = info;
+	_file.open(path, std::ios::binary | std::ios::trunc);
+	if (_file.good())
+	{
+		WriteHeader();
+	}
+	return _file.good();
+}
+
+auto ImageWriter::Write(const Band& band) -> bool
+{
+	_file.write(reinterpret_cast<const char*>(band.Bytes.data()), static_cast<std::streamsize>(band.Bytes.size()));
+	return _file.good();
+}
+
+auto ImageWriter::Close() -> bool
+{
+	WriteTrailer();
+	_file.close();
+	return !_file.fail();
+}
+
+void ImageWriter::WriteHeader()
+{
+}
+
+void ImageWriter::WriteTrailer()
+{
+}
+
+void ImageWriter::ColorRow(const Band& band, int row, int channels, uint8_t* output) const
+{
+	const int* iterations = band.Iterations.data() + static_cast<size_t>(row) * _info.Width;
+	for (int x = 0; x < _info.Width; x++)
+	{
+		const auto& color = _info.Palette->ColorFor(iterations[x], _info.Iterations);
+		std::copy(color.begin(), color.end(), output);
+		if (channels == 4)
+		{
+			output[3] = 255;
+		}
+		output += channels;
+	}
+}
+
+void PpmWriter::Encode(Band& band) const
+{
+	const size_t rowLength = static_cast<size_t>(_info.Width) * 3;
+	band.Bytes.resize(rowLength * band.Rows);
+	for (int row = 0; row < band.Rows; row++)
+	{
+		ColorRow(band, row, 3, band.Bytes.data() + row * rowLength);
+	}
+}
+
+void PpmWriter::WriteHeader()
+{
+	_file << "P6\n" << _info.Width << ' ' << _info.Height << "\n255\n";
+}
+
+void RgbaWriter::Encode(Band& band) const
+{
+	const size_t rowLength = static_cast<size_t>(_info.Width) * 4;
+	band.Bytes.resize(rowLength * band.Rows);
+	for (int row = 0; row < band.Rows; row++)
+	{
+		ColorRow(band, row, 4, band.Bytes.data() + row * rowLength);
+	}
+}
+
+IterationWriter::IterationWriter(const IterationHeader& header) :
+	_header(header)
+{
+}
+
+void IterationWriter::Encode(Band& band) const
+{
+	band.Bytes.resize(static_cast<size_t>(_info.Width) * band.Rows * sizeof(int));
+	std::memcpy(band.Bytes.data(), band.Iterations.data(), band.Bytes.size());
+}
+
+void IterationWriter::WriteHeader()
+{
+	_file.write(reinterpret_cast<const char*>(&_header), sizeof _header);
+}
+}
@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IterationFile.h"
+#include "Palette.h"
+
+namespace Se::Offline
+{
+struct ImageInfo
+{
+	int Width = 0;
+	int Height = 0;
+	int64_t Iterations = 0;
+	const class Palette* Palette = nullptr;
+};
+
+// Whole image rows on their way from the compute pool to the file
+struct Band
+{
+	size_t Index = 0;
+	int Y = 0;
+	int Rows = 0;
+	bool Last = false;
+	std::vector<int> Iterations;
+
+	// What ImageWriter::Encode makes of the rows
+	std::vector<uint8_t> Bytes;
+	// Checksum of the rows before compression and their length, for formats that combine them
+	uint32_t Checksum = 0;
+	size_t RawLength = 0;
+	// Set by ImageWriter::Encode when Bytes could not be made, the image is abandoned
+	bool Failed = false;
+};
+
+// Turns bands into a file. Encoding is split from writing so several threads can compress bands
+// at once while one thread appends them in order.
+class ImageWriter
+{
+public:
+	virtual ~ImageWriter() = default;
+
+	// For the options' format, nothing when it is unknown
+	static auto Create(const Options& options) -> std::unique_ptr<ImageWriter>;
+
+	auto Open(const std::string& path, const ImageInfo& info) -> bool;
+	// Called from several threads at once, for bands in any order
+	virtual void Encode(Band& band) const = 0;
+	// Called from one thread, for bands in image order
+	virtual auto Write(const Band& band) -> bool;
+	auto Close() -> bool;
+
+protected:
+	virtual void WriteHeader();
+	virtual void WriteTrailer();
+
+	// Palette colours of one row of the band, three or four bytes a pixel
+	void ColorRow(const Band& band, int row, int channels, uint8_t* output) const;
+
+protected:
+	std::ofstream _file;
+	ImageInfo _info;
+};
+
+// Binary PPM, the header is all there is to encode
+class PpmWriter : public ImageWriter
+{
+public:
+	void Encode(Band& band) const override;
+
+protected:
+	void WriteHeader() override;
+};
+
+// Headerless RGBA, for tools that take the size on their command line
+class RgbaWriter : public ImageWriter
+{
+public:
+	void Encode(Band& band) const override;
+};
+
+// Iteration counts behind a header holding the view, see IterationFile
+class IterationWriter : public ImageWriter
+{
+public:
+	explicit IterationWriter(const IterationHeader& header);
+
+	void Encode(Band& band) const override;
+
+protected:
+	void WriteHeader() override;
+
+private:
+	IterationHeader _header;
+};
+}
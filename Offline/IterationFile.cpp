@@ -0,0 +1,156 @@
+﻿#include "IterationFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Se::Offline
+{
+auto IterationHeader::From(const Options& options) -> IterationHeader
+{
+	IterationHeader header;
+	std::copy(std::begin(Signature), std::end(Signature), header.Magic);
+	header.HeaderSize = sizeof(IterationHeader);
+	header.Width = options.Width;
+	header.Height = options.Height;
+	header.Iterations = options.Iterations;
+	header.CenterX = options.CenterX.Hi;
+	header.CenterXLow = options.CenterX.Lo;
+	header.CenterY = options.CenterY.Hi;
+	header.CenterYLow = options.CenterY.Lo;
+	header.Zoom = options.Zoom;
+	if (options.Julia)
+	{
+		header.Julia = 1;
+		header.JuliaR = options.Julia->first;
+		header.JuliaI = options.Julia->second;
+	}
+	return header;
+}
+
+void IterationHeader::ApplyTo(Options& options) const
+{
+	options.Width = Width;
+	options.Height = Height;
+	options.Iterations = Iterations;
+	options.CenterX = Coordinate(CenterX) + CenterXLow;
+	options.CenterY = Coordinate(CenterY) + CenterYLow;
+	options.Zoom = Zoom;
+	options.Julia.reset();
+	if (Julia != 0)
+	{
+		options.Julia = std::make_pair(JuliaR, JuliaI);
+	}
+}
+
+IterationFile::~IterationFile()
+{
+	Close();
+}
+
+auto IterationFile::Open(const std::string& path) -> bool
+{
+	Close();
+
+	std::error_code error;
+	const auto size = std::filesystem::file_size(path, error);
+	if (error || size < sizeof(IterationHeader))
+	{
+		return false;
+	}
+
+#if defined(_WIN32)
+	_fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+	                          FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		_fileHandle = nullptr;
+		return false;
+	}
+	_mappingHandle = CreateFileMappingW(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = _mappingHandle != nullptr ? MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr)
+	{
+		Close();
+		return false;
+	}
+#else
+	const int descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		return false;
+	}
+	void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	// Recolouring reads each row once from top to bottom
+	madvise(view, size, MADV_SEQUENTIAL);
+#endif
+
+	_mapped = static_cast<const uint8_t*>(view);
+	_mappedSize = size;
+
+	std::memcpy(&_header, _mapped, sizeof _header);
+	const uint64_t pixels = static_cast<uint64_t>(std::max(_header.Width, 0)) * std::max(_header.Height, 0);
+	const bool valid = std::equal(std::begin(IterationHeader::Signature), std::end(IterationHeader::Signature),
+	                              _header.Magic) &&
+		_header.HeaderSize >= sizeof(IterationHeader) && _header.HeaderSize % sizeof(int) == 0 &&
+		_header.Kind == IterationHeader::Values::Counts && pixels > 0 && _header.Iterations > 0 &&
+		_header.HeaderSize + pixels * sizeof(int) <= _mappedSize;
+	if (!valid)
+	{
+		Close();
+	}
+	return valid;
+}
+
+void IterationFile::Close()
+{
+#if defined(_WIN32)
+	if (_mapped != nullptr)
+	{
+		UnmapViewOfFile(_mapped);
+	}
+	if (_mappingHandle != nullptr)
+	{
+		CloseHandle(_mappingHandle);
+	}
+	if (_fileHandle != nullptr)
+	{
+		CloseHandle(_fileHandle);
+	}
+	_mappingHandle = nullptr;
+	_fileHandle = nullptr;
+#else
+	if (_mapped != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(_mapped), _mappedSize);
+	}
+#endif
+	_mapped = nullptr;
+	_mappedSize = 0;
+}
+
+auto IterationFile::Header() const -> const IterationHeader&
+{
+	return _header;
+}
+
+auto IterationFile::Row(int y) const -> const int*
+{
+	return reinterpret_cast<const int*>(_mapped + _header.HeaderSize) + static_cast<size_t>(y) * _header.Width;
+}
+}
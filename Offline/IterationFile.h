@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Options.h"
+
+namespace Se::Offline
+{
+// Start of an iteration file. Width * Height 32-bit iteration counts follow row by row, HeaderSize
+// bytes in so they can be read straight from a mapping. Everything is in the machine's byte order.
+struct IterationHeader
+{
+	static constexpr char Signature[8] = {'F', 'R', 'I', 'T', 'E', 'R', '1', '\0'};
+
+	enum class Values : uint32_t
+	{
+		// Whole iteration counts, what the kernels produce. Smooth values would get their own kind.
+		Counts
+	};
+
+	char Magic[8] = {};
+	uint32_t HeaderSize = 0;
+	Values Kind = Values::Counts;
+	int32_t Width = 0;
+	int32_t Height = 0;
+	int64_t Iterations = 0;
+
+	double CenterX = 0.0, CenterXLow = 0.0;
+	double CenterY = 0.0, CenterYLow = 0.0;
+	double Zoom = 0.0;
+
+	uint32_t Julia = 0;
+	uint32_t Reserved = 0;
+	double JuliaR = 0.0, JuliaI = 0.0;
+
+	uint8_t Padding[32] = {};
+
+	// The view of a render
+	static auto From(const Options& options) -> IterationHeader;
+	// Puts the view back, for writing a recoloured copy of the file
+	void ApplyTo(Options& options) const;
+};
+
+static_assert(sizeof(IterationHeader) == 128);
+
+// An iteration file mapped for reading, rows are handed out without copying
+class IterationFile
+{
+public:
+	IterationFile() = default;
+	~IterationFile();
+
+	IterationFile(const IterationFile&) = delete;
+	auto operator=(const IterationFile&) -> IterationFile& = delete;
+
+	// False for missing files, other formats and files cut short
+	auto Open(const std::string& path) -> bool;
+	void Close();
+
+	auto Header() const -> const IterationHeader&;
+	auto Row(int y) const -> const int*;
+
+private:
+	const uint8_t* _mapped = nullptr;
+	uint64_t _mappedSize = 0;
+	IterationHeader _header;
+#if defined(_WIN32)
+	void* _fileHandle = nullptr;
+	void* _mappingHandle = nullptr;
+#endif
+};
+}
@@ -0,0 +1,124 @@
+﻿#include <cstdio>
+
+#include "ComputePool.h"
+#include "IterationFile.h"
+#include "Options.h"
+#include "Palette.h"
+#include "Recolorer.h"
+#include "Renderer.h"
+
+namespace
+{
+using namespace Se;
+using namespace Se::Offline;
+
+auto CreateWriter(const Options& options) -> std::unique_ptr<ImageWriter>
+{
+	auto writer = ImageWriter::Create(options);
+	if (writer == nullptr)
+	{
+		std::fprintf(stderr, "Unknown image format \"%s\", see --help\n", options.OutputFormat().c_str());
+	}
+	return writer;
+}
+
+void PrintOutputStats(const OutputStats& output)
+{
+	// Output time that overlapped compute cost nothing, the stalls and the tail are what it added
+	const double outputSeconds = output.EncodeSeconds + output.WriteSeconds;
+	std::fprintf(stderr, "Output %.2f s (%.2f encoding, %.2f writing, %.1f MB), %.0f%% overlapped with compute\n",
+	             outputSeconds, output.EncodeSeconds, output.WriteSeconds, output.Bytes / 1e6,
+	             outputSeconds > 0.0 ? output.OverlappedSeconds / outputSeconds * 100.0 : 0.0);
+	std::fprintf(stderr, "Compute waited %.2f s for output, %.2f s of output after the last band\n",
+	             output.StallSeconds, output.TailSeconds);
+}
+
+auto Render(const Options& options, const Palette& palette) -> int
+{
+	const auto writer = CreateWriter(options);
+	if (writer == nullptr)
+	{
+		return 1;
+	}
+
+	Renderer renderer(options, palette);
+	std::fprintf(stderr, "%dx%d, %s kernels, %s, %zu threads\n", options.Width, options.Height,
+	             Kernels::IsaName(Kernels::Active().Isa), Kernels::PrecisionName(renderer.ViewPrecision()),
+	             ComputePool::Instance().ThreadCount());
+	if (!renderer.Render(*writer))
+	{
+		return 1;
+	}
+
+	const auto& stats = renderer.Stats();
+	const double lanes = stats.VectorIterations > 0
+		                     ? static_cast<double>(stats.LaneIterations) / static_cast<double>(stats.VectorIterations)
+		                     : 0.0;
+	std::fprintf(stderr, "%.2f s, %zu tiles (%zu stolen), %.0f%% lanes busy\n", stats.Seconds, stats.Tiles,
+	             stats.StolenTiles, lanes * 100.0);
+	for (size_t i = 0; i < stats.PrecisionTiles.size(); i++)
+	{
+		if (stats.PrecisionTiles[i] > 0 && stats.PrecisionTiles[i] < stats.Tiles)
+		{
+			std::fprintf(stderr, "%zu tiles in %s\n", stats.PrecisionTiles[i],
+			             Kernels::PrecisionName(static_cast<Kernels::Precision>(i)));
+		}
+	}
+	PrintOutputStats(renderer.Output());
+	return 0;
+}
+
+auto Recolor(const Options& options, const Palette& palette) -> int
+{
+	IterationFile input;
+	if (!input.Open(options.Input))
+	{
+		std::fprintf(stderr, "%s is not an iteration file\n", options.Input.c_str());
+		return 1;
+	}
+
+	// The file's view, so a recolored iteration file keeps it
+	Options view = options;
+	input.Header().ApplyTo(view);
+	const auto writer = CreateWriter(view);
+	if (writer == nullptr)
+	{
+		return 1;
+	}
+
+	std::fprintf(stderr, "%dx%d at %lld iterations\n", view.Width, view.Height, static_cast<long long>(view.Iterations));
+	Recolorer recolorer(view, palette);
+	if (!recolorer.Recolor(input, *writer))
+	{
+		return 1;
+	}
+
+	const auto& output = recolorer.Output();
+	std::fprintf(stderr, "%.2f s, %.2f s colouring and encoding, %.2f s writing, %.1f MB\n", recolorer.Seconds(),
+	             output.EncodeSeconds, output.WriteSeconds, output.Bytes / 1e6);
+	return 0;
+}
+}
+
+int main(int argc, char** argv)
+{
+	const auto options = Options::Parse(argc, argv);
+	if (!options)
+	{
+		return 1;
+	}
+
+	const auto palette = Palette::Load(options->Palette, options->Assets);
+	if (!palette)
+	{
+		std::fprintf(stderr, "Could not load %s%s\n", options->Assets.c_str(), PaletteFile(options->Palette));
+		return 1;
+	}
+
+	if (options->Threads > 0)
+	{
+		ComputePool::Instance().SetThreadCount(options->Threads);
+	}
+
+	return options->Input.empty() ? Render(*options, *palette) : Recolor(*options, *palette);
+}
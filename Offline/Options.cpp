@@ -0,0 +1,245 @@
+﻿#include "Options.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Se::Offline
+{
+namespace
+{
+auto ParseNumber(const char* text, double& value) -> bool
+{
+	char* end = nullptr;
+	value = std::strtod(text, &end);
+	return end != text && *end == '\0';
+}
+
+template <class Integer>
+auto ParseInteger(const char* text, Integer& value) -> bool
+{
+	char* end = nullptr;
+	const long long parsed = std::strtoll(text, &end, 10);
+	value = static_cast<Integer>(parsed);
+	return end != text && *end == '\0' && parsed > 0;
+}
+
+auto ParsePalette(const char* text, PaletteType& palette) -> bool
+{
+	for (int i = 0; i < static_cast<int>(PaletteType::Count); i++)
+	{
+		// Names are matched without spaces or case, "fieryalt" picks "Fiery Alt"
+		std::string name;
+		for (const char* c = PaletteName(static_cast<PaletteType>(i)); *c != '\0'; c++)
+		{
+			if (*c != ' ')
+			{
+				name += static_cast<char>(std::tolower(static_cast<unsigned char>(*c)));
+			}
+		}
+		if (name == text)
+		{
+			palette = static_cast<PaletteType>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+auto ParsePrecision(const char* text, std::optional<Kernels::Precision>& precision) -> bool
+{
+	for (const auto candidate : {Kernels::Precision::Float, Kernels::Precision::Double, Kernels::Precision::DoubleDouble})
+	{
+		if (std::strcmp(text, Kernels::PrecisionName(candidate)) == 0)
+		{
+			precision = candidate;
+			return true;
+		}
+	}
+	return std::strcmp(text, "Automatic") == 0;
+}
+}
+
+auto Options::Parse(int argc, char** argv) -> std::optional<Options>
+{
+	Options options;
+	int first = 1;
+	if (argc > 1 && std::strcmp(argv[1], "recolor") == 0)
+	{
+		if (argc < 3)
+		{
+			std::fprintf(stderr, "recolor needs an iteration file\n");
+			return std::nullopt;
+		}
+		options.Input = argv[2];
+		first = 3;
+	}
+
+	for (int i = first; i < argc; i++)
+	{
+		const std::string flag = argv[i];
+		// Every option takes one value except the two-value ones
+		const int values = flag == "--centre" || flag == "--julia" ? 2 : 1;
+		if (flag == "--help")
+		{
+			PrintUsage();
+			return std::nullopt;
+		}
+		if (i + values >= argc)
+		{
+			std::fprintf(stderr, "%s needs %d value%s\n", flag.c_str(), values, values > 1 ? "s" : "");
+			return std::nullopt;
+		}
+		const char* value = argv[i + 1];
+
+		bool valid;
+		if (flag == "--centre")
+		{
+			const auto x = Coordinate::Parse(argv[i + 1]);
+			const auto y = Coordinate::Parse(argv[i + 2]);
+			valid = x && y;
+			if (valid)
+			{
+				options.CenterX = *x;
+				options.CenterY = *y;
+			}
+		}
+		else if (flag == "--julia")
+		{
+			std::pair<double, double> c;
+			valid = ParseNumber(argv[i + 1], c.first) && ParseNumber(argv[i + 2], c.second);
+			options.Julia = c;
+		}
+		else if (flag == "--zoom")
+		{
+			valid = ParseNumber(value, options.Zoom) && options.Zoom > 0.0;
+		}
+		else if (flag == "--iterations")
+		{
+			valid = ParseInteger(value, options.Iterations);
+		}
+		else if (flag == "--palette")
+		{
+			valid = ParsePalette(value, options.Palette);
+		}
+		else if (flag == "--width")
+		{
+			valid = ParseInteger(value, options.Width);
+		}
+		else if (flag == "--height")
+		{
+			valid = ParseInteger(value, options.Height);
+		}
+		else if (flag == "--precision")
+		{
+			valid = ParsePrecision(value, options.Precision);
+		}
+		else if (flag == "--periodicity")
+		{
+			options.Periodicity = std::strcmp(value, "on") == 0;
+			valid = options.Periodicity || std::strcmp(value, "off") == 0;
+		}
+		else if (flag == "--tile")
+		{
+			valid = ParseInteger(value, options.TileSize);
+		}
+		else if (flag == "--threads")
+		{
+			valid = ParseInteger(value, options.Threads);
+		}
+		else if (flag == "--format")
+		{
+			options.Format = value;
+			valid = true;
+		}
+		else if (flag == "--compression")
+		{
+			char* end = nullptr;
+			options.Compression = static_cast<int>(std::strtol(value, &end, 10));
+			valid = end != value && *end == '\0' && options.Compression >= 0 && options.Compression <= 9;
+		}
+		else if (flag == "--writers")
+		{
+			valid = ParseInteger(value, options.WriterThreads);
+		}
+		else if (flag == "--queue")
+		{
+			valid = ParseInteger(value, options.QueueDepth);
+		}
+		else if (flag == "--output")
+		{
+			options.Output = value;
+			valid = true;
+		}
+		else if (flag == "--assets")
+		{
+			options.Assets = value;
+			if (!options.Assets.empty() && options.Assets.back() != '/' && options.Assets.back() != '\\')
+			{
+				options.Assets += '/';
+			}
+			valid = true;
+		}
+		else
+		{
+			std::fprintf(stderr, "Unknown option %s, see --help\n", flag.c_str());
+			return std::nullopt;
+		}
+
+		if (!valid)
+		{
+			std::fprintf(stderr, "Invalid value for %s\n", flag.c_str());
+			return std::nullopt;
+		}
+		i += values;
+	}
+	return options;
+}
+
+void Options::PrintUsage()
+{
+	std::printf(
+		"Renders a fractal to an image file without a window, in bands of tiles on every core\n"
+		"\n"
+		"  FractalsOffline [options]\n"
+		"  FractalsOffline recolor <file.iter> [options]\n"
+		"\n"
+		"recolor colours an iteration file written with --format iter again, without computing it.\n"
+		"The view comes from the file, only the palette and output options apply.\n"
+		"\n"
+		"  --centre <x> <y>       View centre, decimals keep up to 32 digits (-0.5 0)\n"
+		"  --zoom <factor>        The image is 4 / factor units wide (1)\n"
+		"  --iterations <count>   Iteration limit (1000)\n"
+		"  --palette <name>       fiery, fieryalt, uv, greyscale or rainbow (fiery)\n"
+		"  --width <pixels>       Image width (1920)\n"
+		"  --height <pixels>      Image height (1080)\n"
+		"  --julia <cr> <ci>      Julia set for c instead of the Mandelbrot set\n"
+		"  --precision <name>     32-bit, 64-bit, Double-double or Automatic (Automatic)\n"
+		"  --periodicity <on|off> Periodicity checking in the escape loops (on)\n"
+		"  --tile <pixels>        Tile size, also the height of a band (64)\n"
+		"  --threads <count>      Compute threads (all cores)\n"
+		"  --output <path>        Image to write (fractal.png)\n"
+		"  --format <name>        png, ppm, rgba or iter, iter keeping the counts to recolor (from --output)\n"
+		"  --compression <level>  PNG zlib level, 0 to 9 (6)\n"
+		"  --writers <count>      Threads colouring and compressing bands, besides the one writing\n"
+		"                         (2 when rendering, every core when recoloring)\n"
+		"  --queue <bands>        Bands computed ahead of the file before compute waits for it (8)\n"
+		"  --assets <path>        Texture assets holding Pals/ (Assets/Textures/)\n");
+}
+
+auto Options::Spacing() const -> double
+{
+	return 4.0 / (Zoom * Width);
+}
+
+auto Options::OutputFormat() const -> std::string
+{
+	if (!Format.empty())
+	{
+		return Format;
+	}
+	const auto dot = Output.find_last_of('.');
+	return dot == std::string::npos ? "" : Output.substr(dot + 1);
+}
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "Coordinate.h"
+#include "Palettes.h"
+#include "Kernels/Kernels.h"
+
+namespace Se::Offline
+{
+struct Options
+{
+	Coordinate CenterX = -0.5;
+	Coordinate CenterY = 0.0;
+	// At zoom 1 the image is 4 units wide, pixels are square
+	double Zoom = 1.0;
+	int64_t Iterations = 1000;
+	PaletteType Palette = PaletteType::Fiery;
+	int Width = 1920;
+	int Height = 1080;
+
+	// Julia set for this c instead of the Mandelbrot set
+	std::optional<std::pair<double, double>> Julia;
+	// Picked from the pixel spacing when not given
+	std::optional<Kernels::Precision> Precision;
+	bool Periodicity = true;
+
+	int TileSize = 64;
+	// Every core when zero
+	size_t Threads = 0;
+
+	std::string Output = "fractal.png";
+	// png, ppm, rgba or iter, taken from the output's extension when empty
+	std::string Format;
+	// zlib level for PNG
+	int Compression = 6;
+	// Threads colouring and compressing bands, a separate one writes them. Picked for the job when zero.
+	size_t WriterThreads = 0;
+	// Bands computed ahead of the file before compute waits for it
+	size_t QueueDepth = 8;
+	// Where the palette images are, the window loads them from the same place
+	std::string Assets = "Assets/Textures/";
+	// Iteration file to recolor instead of rendering
+	std::string Input;
+
+	// Prints what is wrong and returns nothing for arguments that make no sense
+	static auto Parse(int argc, char** argv) -> std::optional<Options>;
+	static void PrintUsage();
+
+	// Distance between neighbouring pixel centres
+	auto Spacing() const -> double;
+	auto OutputFormat() const -> std::string;
+};
+}
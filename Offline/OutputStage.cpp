@@ -0,0 +1,186 @@
+﻿#include "OutputStage.h"
+
+#include <algorithm>
+
+namespace Se::Offline
+{
+namespace
+{
+auto Seconds(OutputStage::Clock::duration duration) -> double
+{
+	return std::chrono::duration<double>(duration).count();
+}
+}
+
+OutputStage::OutputStage(ImageWriter& writer, size_t bandPixels, size_t bandCount, size_t encoderCount) :
+	_writer(writer)
+{
+	for (size_t i = 0; i < std::max<size_t>(bandCount, 1); i++)
+	{
+		auto band = std::make_unique<Band>();
+		band->Iterations.resize(bandPixels);
+		_free.push_back(std::move(band));
+	}
+	for (size_t i = 0; i < std::max<size_t>(encoderCount, 1); i++)
+	{
+		_encoders.emplace_back(&OutputStage::Encode, this);
+	}
+	_writerThread = std::thread(&OutputStage::Write, this);
+}
+
+OutputStage::~OutputStage()
+{
+	Stop();
+}
+
+auto OutputStage::Acquire() -> std::unique_ptr<Band>
+{
+	const auto start = Clock::now();
+	std::unique_lock lock(_mutex);
+	_changed.wait(lock, [this] { return !_free.empty() || _failed; });
+	_stats.StallSeconds += Seconds(Clock::now() - start);
+	if (_failed)
+	{
+		return nullptr;
+	}
+
+	auto band = std::move(_free.back());
+	_free.pop_back();
+	return band;
+}
+
+void OutputStage::Submit(std::unique_ptr<Band> band)
+{
+	{
+		std::scoped_lock lock(_mutex);
+		if (band->Last)
+		{
+			_computeEnd = Clock::now();
+		}
+		_queued.push_back(std::move(band));
+		_submitted++;
+	}
+	_changed.notify_all();
+}
+
+auto OutputStage::Finish() -> bool
+{
+	{
+		std::unique_lock lock(_mutex);
+		_changed.wait(lock, [this] { return _written == _submitted || _failed; });
+	}
+	const auto end = Clock::now();
+	Stop();
+
+	// Only the stretch of each busy interval before the last band was computed ran alongside compute
+	if (_computeEnd == Clock::time_point{})
+	{
+		_computeEnd = end;
+	}
+	for (const auto& interval : _busy)
+	{
+		_stats.OverlappedSeconds += Seconds(std::max(Clock::duration::zero(),
+		                                             std::min(interval.End, _computeEnd) - interval.Start));
+	}
+	_stats.TailSeconds = Seconds(end - _computeEnd);
+	return !_failed;
+}
+
+auto OutputStage::Stats() const -> const OutputStats&
+{
+	return _stats;
+}
+
+void OutputStage::Encode()
+{
+	while (true)
+	{
+		std::unique_ptr<Band> band;
+		{
+			std::unique_lock lock(_mutex);
+			_changed.wait(lock, [this] { return _stopping || _failed || !_queued.empty(); });
+			if (_failed || _queued.empty())
+			{
+				return;
+			}
+			band = std::move(_queued.front());
+			_queued.pop_front();
+		}
+
+		const auto start = Clock::now();
+		band->Failed = false;
+		_writer.Encode(*band);
+		const auto end = Clock::now();
+
+		{
+			std::scoped_lock lock(_mutex);
+			_busy.push_back({start, end});
+			_stats.EncodeSeconds += Seconds(end - start);
+			_failed = _failed || band->Failed;
+			_encoded.push_back(std::move(band));
+		}
+		_changed.notify_all();
+	}
+}
+
+void OutputStage::Write()
+{
+	while (true)
+	{
+		std::unique_ptr<Band> band;
+		{
+			// Bands finish encoding in any order, the file takes them in order
+			std::unique_lock lock(_mutex);
+			auto next = _encoded.end();
+			_changed.wait(lock, [&]
+			{
+				next = std::find_if(_encoded.begin(), _encoded.end(), [this](const auto& encoded)
+				{
+					return encoded->Index == _written;
+				});
+				return _stopping || _failed || next != _encoded.end();
+			});
+			// Nothing after a band that failed to encode or write belongs in the file
+			if (_failed || next == _encoded.end())
+			{
+				return;
+			}
+			band = std::move(*next);
+			_encoded.erase(next);
+		}
+
+		const auto start = Clock::now();
+		const bool written = _writer.Write(*band);
+		const auto end = Clock::now();
+
+		{
+			std::scoped_lock lock(_mutex);
+			_busy.push_back({start, end});
+			_stats.WriteSeconds += Seconds(end - start);
+			_stats.Bytes += band->Bytes.size();
+			_failed = _failed || !written;
+			_written++;
+			_free.push_back(std::move(band));
+		}
+		_changed.notify_all();
+	}
+}
+
+void OutputStage::Stop()
+{
+	{
+		std::scoped_lock lock(_mutex);
+		if (_stopping)
+		{
+			return;
+		}
+		_stopping = true;
+	}
+	_changed.notify_all();
+	for (auto& encoder : _encoders)
+	{
+		encoder.join();
+	}
+	_writerThread.join();
+}
+}
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ImageWriter.h"
+
+namespace Se::Offline
+{
+struct OutputStats
+{
+	double EncodeSeconds = 0.0;
+	double WriteSeconds = 0.0;
+	// Encoding and writing done while bands were still being computed
+	double OverlappedSeconds = 0.0;
+	// Time compute waited for a free band because output fell behind
+	double StallSeconds = 0.0;
+	// From the last band computed to the last band written
+	double TailSeconds = 0.0;
+	size_t Bytes = 0;
+};
+
+// Encodes bands on its own threads and writes them in image order while the compute pool goes on
+// with the next. A fixed number of band buffers go round between compute and output, once all of
+// them are queued Acquire blocks and compute waits for the file.
+class OutputStage
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	OutputStage(ImageWriter& writer, size_t bandPixels, size_t bandCount, size_t encoderCount);
+	~OutputStage();
+
+	OutputStage(const OutputStage&) = delete;
+	auto operator=(const OutputStage&) -> OutputStage& = delete;
+
+	// Nothing once writing has failed
+	auto Acquire() -> std::unique_ptr<Band>;
+	void Submit(std::unique_ptr<Band> band);
+	// Waits until every submitted band is written, false if any write failed
+	auto Finish() -> bool;
+
+	auto Stats() const -> const OutputStats&;
+
+private:
+	struct Interval
+	{
+		Clock::time_point Start, End;
+	};
+
+	void Encode();
+	void Write();
+	void Stop();
+
+private:
+	ImageWriter& _writer;
+
+	std::mutex _mutex;
+	std::condition_variable _changed;
+	std::vector<std::unique_ptr<Band>> _free;
+	std::deque<std::unique_ptr<Band>> _queued;
+	std::vector<std::unique_ptr<Band>> _encoded;
+	size_t _submitted = 0;
+	size_t _written = 0;
+	bool _stopping = false;
+	bool _failed = false;
+
+	std::vector<Interval> _busy;
+	Clock::time_point _computeEnd;
+	OutputStats _stats;
+
+	std::vector<std::thread> _encoders;
+	std::thread _writerThread;
+};
+}
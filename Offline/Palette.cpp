@@ -0,0 +1,136 @@
+﻿#include "Palette.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include <zlib.h>
+
+namespace Se::Offline
+{
+namespace
+{
+auto ReadBigEndian(const uint8_t* bytes) -> uint32_t
+{
+	return static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 |
+		static_cast<uint32_t>(bytes[2]) << 8 | static_cast<uint32_t>(bytes[3]);
+}
+
+// Reverses the filter of the first scanline in place. Without a row above, up is zero, Average
+// halves the left byte and Paeth always predicts the left byte.
+auto UnfilterFirstRow(uint8_t filter, uint8_t* row, size_t length, size_t bpp) -> bool
+{
+	for (size_t i = bpp; i < length; i++)
+	{
+		const uint8_t left = row[i - bpp];
+		switch (filter)
+		{
+		case 0:
+		case 2: break;
+		case 1:
+		case 4: row[i] += left; break;
+		case 3: row[i] += left / 2; break;
+		default: return false;
+		}
+	}
+	return filter <= 4;
+}
+}
+
+auto Palette::Load(const std::string& path) -> std::optional<Palette>
+{
+	std::ifstream file(path, std::ios::binary);
+	const std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+	constexpr uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	if (bytes.size() < sizeof signature || !std::equal(std::begin(signature), std::end(signature), bytes.begin()))
+	{
+		return std::nullopt;
+	}
+
+	uint32_t width = 0, height = 0;
+	size_t bpp = 0;
+	std::vector<uint8_t> compressed;
+	for (size_t offset = sizeof signature; offset + 12 <= bytes.size();)
+	{
+		const uint32_t length = ReadBigEndian(&bytes[offset]);
+		const std::string type(reinterpret_cast<const char*>(&bytes[offset + 4]), 4);
+		const uint8_t* data = &bytes[offset + 8];
+		if (offset + 12 + length > bytes.size())
+		{
+			return std::nullopt;
+		}
+
+		if (type == "IHDR")
+		{
+			width = ReadBigEndian(data);
+			height = ReadBigEndian(data + 4);
+			const uint8_t depth = data[8], colorType = data[9], interlace = data[12];
+			if (depth != 8 || (colorType != 2 && colorType != 6) || interlace != 0)
+			{
+				return std::nullopt;
+			}
+			bpp = colorType == 6 ? 4 : 3;
+		}
+		else if (type == "IDAT")
+		{
+			compressed.insert(compressed.end(), data, data + length);
+		}
+		else if (type == "IEND")
+		{
+			break;
+		}
+		offset += 12 + length;
+	}
+	if (width == 0 || height == 0 || bpp == 0)
+	{
+		return std::nullopt;
+	}
+
+	// Only the first row is a palette, the rest of the image is never inflated
+	const size_t stride = 1 + width * bpp;
+	std::vector<uint8_t> row(stride);
+	z_stream stream{};
+	stream.next_in = compressed.data();
+	stream.avail_in = static_cast<uInt>(compressed.size());
+	stream.next_out = row.data();
+	stream.avail_out = static_cast<uInt>(row.size());
+	if (inflateInit(&stream) != Z_OK)
+	{
+		return std::nullopt;
+	}
+	const int status = inflate(&stream, Z_SYNC_FLUSH);
+	const bool complete = stream.avail_out == 0;
+	inflateEnd(&stream);
+	if ((status != Z_OK && status != Z_STREAM_END) || !complete ||
+		!UnfilterFirstRow(row[0], row.data() + 1, stride - 1, bpp))
+	{
+		return std::nullopt;
+	}
+
+	Palette palette;
+	palette._colors.resize(width);
+	for (uint32_t x = 0; x < width; x++)
+	{
+		std::copy_n(&row[1 + x * bpp], 3, palette._colors[x].begin());
+	}
+	return palette;
+}
+
+auto Palette::Load(PaletteType type, const std::string& assets) -> std::optional<Palette>
+{
+	return Load(assets + PaletteFile(type));
+}
+
+auto Palette::Width() const -> int
+{
+	return static_cast<int>(_colors.size());
+}
+
+auto Palette::ColorFor(int iteration, int64_t iterations) const -> const Color&
+{
+	const float offset = static_cast<float>(std::max(iteration, 0)) / static_cast<float>(iterations) *
+		static_cast<float>(_colors.size() - 1);
+	return _colors[std::min(static_cast<size_t>(offset), _colors.size() - 1)];
+}
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Palettes.h"
+
+namespace Se::Offline
+{
+// The first row of a palette image, read straight from the PNG without the engine's image loader
+class Palette
+{
+public:
+	using Color = std::array<uint8_t, 3>;
+
+	// Nothing if the file is missing or not an 8-bit, non-interlaced RGB or RGBA PNG
+	static auto Load(const std::string& path) -> std::optional<Palette>;
+	static auto Load(PaletteType type, const std::string& assets) -> std::optional<Palette>;
+
+	auto Width() const -> int;
+	// Maps iterations onto the palette like CpuHost::RenderImage, glitched pixels count as zero
+	auto ColorFor(int iteration, int64_t iterations) const -> const Color&;
+
+private:
+	std::vector<Color> _colors;
+};
+}
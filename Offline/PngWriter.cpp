@@ -0,0 +1,128 @@
+﻿#include "PngWriter.h"
+
+#include <algorithm>
+
+#include <zlib.h>
+
+namespace Se::Offline
+{
+namespace
+{
+void AppendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+{
+	bytes.push_back(static_cast<uint8_t>(value >> 24));
+	bytes.push_back(static_cast<uint8_t>(value >> 16));
+	bytes.push_back(static_cast<uint8_t>(value >> 8));
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+void WriteBigEndian(uint8_t* bytes, uint32_t value)
+{
+	bytes[0] = static_cast<uint8_t>(value >> 24);
+	bytes[1] = static_cast<uint8_t>(value >> 16);
+	bytes[2] = static_cast<uint8_t>(value >> 8);
+	bytes[3] = static_cast<uint8_t>(value);
+}
+
+// Length, type and checksum around data that is already in place after the first eight bytes
+void FrameChunk(std::vector<uint8_t>& chunk, const char* type)
+{
+	const auto length = static_cast<uint32_t>(chunk.size() - 8);
+	WriteBigEndian(chunk.data(), length);
+	std::copy_n(type, 4, chunk.begin() + 4);
+	AppendBigEndian(chunk, static_cast<uint32_t>(crc32(0, chunk.data() + 4, length + 4)));
+}
+}
+
+PngWriter::PngWriter(int compression) :
+	_compression(compression)
+{
+}
+
+void PngWriter::Encode(Band& band) const
+{
+	// Sub filtered rows, they only depend on themselves so bands stay independent
+	const size_t rowLength = 1 + static_cast<size_t>(_info.Width) * 3;
+	thread_local std::vector<uint8_t> rows;
+	rows.resize(rowLength * band.Rows);
+	for (int row = 0; row < band.Rows; row++)
+	{
+		uint8_t* output = rows.data() + row * rowLength;
+		output[0] = 1;
+		ColorRow(band, row, 3, output + 1);
+		for (size_t i = rowLength - 1; i > 3; i--)
+		{
+			output[i] -= output[i - 3];
+		}
+	}
+	band.RawLength = rows.size();
+	band.Checksum = static_cast<uint32_t>(adler32(1, rows.data(), static_cast<uInt>(rows.size())));
+
+	z_stream stream{};
+	// Raw deflate, the zlib header and checksum are written once for the whole image
+	if (deflateInit2(&stream, _compression, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		band.Failed = true;
+		return;
+	}
+	band.Bytes.resize(8 + deflateBound(&stream, static_cast<uLong>(rows.size())) + 16);
+	stream.next_in = rows.data();
+	stream.avail_in = static_cast<uInt>(rows.size());
+	stream.next_out = band.Bytes.data() + 8;
+	stream.avail_out = static_cast<uInt>(band.Bytes.size() - 8);
+	// A sync flush ends on a byte boundary without closing the stream, only the last band does that.
+	// The output has room for everything, so anything short of all input taken is an error.
+	const int result = deflate(&stream, band.Last ? Z_FINISH : Z_SYNC_FLUSH);
+	band.Failed = (band.Last ? result != Z_STREAM_END : result != Z_OK) || stream.avail_in != 0;
+	band.Bytes.resize(8 + stream.total_out);
+	deflateEnd(&stream);
+	if (band.Failed)
+	{
+		return;
+	}
+
+	FrameChunk(band.Bytes, "IDAT");
+}
+
+auto PngWriter::Write(const Band& band) -> bool
+{
+	_adler = static_cast<uint32_t>(adler32_combine(_adler, band.Checksum, static_cast<z_off_t>(band.RawLength)));
+	return ImageWriter::Write(band);
+}
+
+void PngWriter::WriteHeader()
+{
+	constexpr uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	_file.write(reinterpret_cast<const char*>(signature), sizeof signature);
+
+	std::vector<uint8_t> header;
+	AppendBigEndian(header, static_cast<uint32_t>(_info.Width));
+	AppendBigEndian(header, static_cast<uint32_t>(_info.Height));
+	// 8-bit RGB, deflate, adaptive filtering, not interlaced
+	header.insert(header.end(), {8, 2, 0, 0, 0});
+	WriteChunk("IHDR", header.data(), header.size());
+
+	// The zlib header gets an IDAT of its own, chunk boundaries mean nothing to the stream
+	constexpr uint8_t zlibHeader[] = {0x78, 0x9c};
+	WriteChunk("IDAT", zlibHeader, sizeof zlibHeader);
+}
+
+void PngWriter::WriteTrailer()
+{
+	uint8_t adler[4];
+	WriteBigEndian(adler, _adler);
+	WriteChunk("IDAT", adler, sizeof adler);
+	WriteChunk("IEND", nullptr, 0);
+}
+
+void PngWriter::WriteChunk(const char* type, const uint8_t* data, size_t length)
+{
+	std::vector<uint8_t> chunk(8);
+	if (length > 0)
+	{
+		chunk.insert(chunk.end(), data, data + length);
+	}
+	FrameChunk(chunk, type);
+	_file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+}
+}
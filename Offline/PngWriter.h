@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include "ImageWriter.h"
+
+namespace Se::Offline
+{
+// Every band is deflated on its own and ends on a byte boundary, so the bands concatenate into
+// one zlib stream and compress in parallel. Each band becomes an IDAT chunk, the stream's
+// checksum is combined from the bands' in image order.
+class PngWriter : public ImageWriter
+{
+public:
+	explicit PngWriter(int compression);
+
+	void Encode(Band& band) const override;
+	auto Write(const Band& band) -> bool override;
+
+protected:
+	void WriteHeader() override;
+	void WriteTrailer() override;
+
+private:
+	void WriteChunk(const char* type, const uint8_t* data, size_t length);
+
+private:
+	int _compression;
+	uint32_t _adler = 1;
+};
+}
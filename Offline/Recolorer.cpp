@@ -0,0 +1,68 @@
+﻿#include "Recolorer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "ComputePool.h"
+
+namespace Se::Offline
+{
+Recolorer::Recolorer(const Options& options, const Palette& palette) :
+	_options(options),
+	_palette(palette)
+{
+}
+
+auto Recolorer::Recolor(const IterationFile& input, ImageWriter& writer) -> bool
+{
+	const auto& header = input.Header();
+	if (!writer.Open(_options.Output, {header.Width, header.Height, header.Iterations, &_palette}))
+	{
+		std::fprintf(stderr, "Could not open %s\n", _options.Output.c_str());
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	// Nothing is computed, colouring and encoding is all the work there is
+	OutputStage output(writer, static_cast<size_t>(header.Width) * _options.TileSize, _options.QueueDepth,
+	                   _options.WriterThreads > 0 ? _options.WriterThreads : ComputePool::DefaultThreadCount());
+	const int bandCount = (header.Height + _options.TileSize - 1) / _options.TileSize;
+	for (int index = 0; index < bandCount; index++)
+	{
+		auto band = output.Acquire();
+		if (band == nullptr)
+		{
+			break;
+		}
+		band->Index = index;
+		band->Y = index * _options.TileSize;
+		band->Rows = std::min(_options.TileSize, header.Height - band->Y);
+		band->Last = index == bandCount - 1;
+		std::memcpy(band->Iterations.data(), input.Row(band->Y),
+		            static_cast<size_t>(header.Width) * band->Rows * sizeof(int));
+		output.Submit(std::move(band));
+	}
+
+	const bool written = output.Finish();
+	_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	_output = output.Stats();
+	if (!written || !writer.Close())
+	{
+		std::fprintf(stderr, "Writing %s failed\n", _options.Output.c_str());
+		return false;
+	}
+	return true;
+}
+
+auto Recolorer::Seconds() const -> double
+{
+	return _seconds;
+}
+
+auto Recolorer::Output() const -> const OutputStats&
+{
+	return _output;
+}
+}
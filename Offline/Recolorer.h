@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include "ImageWriter.h"
+#include "IterationFile.h"
+#include "Options.h"
+#include "OutputStage.h"
+#include "Palette.h"
+
+namespace Se::Offline
+{
+// Colours an iteration file again without computing anything. Bands of rows are copied out of the
+// mapping top to bottom and coloured and encoded by the output stage's threads in parallel, so
+// memory stays at a few bands however large the file is.
+class Recolorer
+{
+public:
+	Recolorer(const Options& options, const Palette& palette);
+
+	auto Recolor(const IterationFile& input, ImageWriter& writer) -> bool;
+
+	auto Seconds() const -> double;
+	auto Output() const -> const OutputStats&;
+
+private:
+	const Options& _options;
+	const Palette& _palette;
+
+	double _seconds = 0.0;
+	OutputStats _output;
+};
+}
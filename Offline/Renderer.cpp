@@ -0,0 +1,201 @@
+﻿#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+#include "ComputePool.h"
+
+namespace Se::Offline
+{
+Renderer::Renderer(const Options& options, const Palette& palette) :
+	_options(options),
+	_palette(palette),
+	_spacing(options.Spacing()),
+	_precision(options.Precision.value_or(ChoosePrecision()))
+{
+}
+
+auto Renderer::Render(ImageWriter& writer) -> bool
+{
+	if (!writer.Open(_options.Output, {_options.Width, _options.Height, _options.Iterations, &_palette}))
+	{
+		std::fprintf(stderr, "Could not open %s\n", _options.Output.c_str());
+		return false;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	// Compute keeps every core busy, output only has to keep up
+	OutputStage output(writer, static_cast<size_t>(_options.Width) * _options.TileSize, _options.QueueDepth,
+	                   _options.WriterThreads > 0 ? _options.WriterThreads : 2);
+	const int bandCount = (_options.Height + _options.TileSize - 1) / _options.TileSize;
+	for (int index = 0; index < bandCount; index++)
+	{
+		auto band = output.Acquire();
+		if (band == nullptr)
+		{
+			break;
+		}
+		band->Index = index;
+		band->Y = index * _options.TileSize;
+		band->Rows = std::min(_options.TileSize, _options.Height - band->Y);
+		band->Last = index == bandCount - 1;
+		ComputeBand(*band);
+		output.Submit(std::move(band));
+		std::fprintf(stderr, "\rBand %d of %d", index + 1, bandCount);
+	}
+	std::fprintf(stderr, "\n");
+
+	const bool written = output.Finish();
+	_stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	_output = output.Stats();
+	if (!written || !writer.Close())
+	{
+		std::fprintf(stderr, "Writing %s failed\n", _options.Output.c_str());
+		return false;
+	}
+	return true;
+}
+
+auto Renderer::Stats() const -> const RenderStats&
+{
+	return _stats;
+}
+
+auto Renderer::Output() const -> const OutputStats&
+{
+	return _output;
+}
+
+auto Renderer::ViewPrecision() const -> Kernels::Precision
+{
+	return _precision;
+}
+
+void Renderer::ComputeBand(Band& band)
+{
+	auto& pool = ComputePool::Instance();
+	const size_t workerCount = pool.ThreadCount();
+	_scheduler.Schedule({{0, band.Y, _options.Width, band.Rows}}, _options.TileSize, workerCount);
+
+	pool.Dispatch(workerCount, [this, &band](size_t index)
+	{
+		RenderStats stats;
+		std::vector<Kernels::Span> spans;
+		Tile tile;
+		bool stolen = false;
+		while (_scheduler.Next(index, tile, stolen))
+		{
+			ComputeTile(tile, band, spans, stats);
+			stats.Tiles++;
+			stats.StolenTiles += stolen ? 1 : 0;
+		}
+
+		std::scoped_lock lock(_statsMutex);
+		_stats.Tiles += stats.Tiles;
+		_stats.StolenTiles += stats.StolenTiles;
+		_stats.LaneIterations += stats.LaneIterations;
+		_stats.VectorIterations += stats.VectorIterations;
+		_stats.SavedIterations += stats.SavedIterations;
+		_stats.SkippedPixels += stats.SkippedPixels;
+		for (size_t i = 0; i < stats.PrecisionTiles.size(); i++)
+		{
+			_stats.PrecisionTiles[i] += stats.PrecisionTiles[i];
+		}
+	}).Wait();
+}
+
+void Renderer::ComputeTile(const Tile& tile, Band& band, std::vector<Kernels::Span>& spans, RenderStats& stats)
+{
+	const auto precision = TilePrecision(tile);
+	stats.PrecisionTiles[static_cast<size_t>(precision)]++;
+
+	const auto x0 = _options.CenterX + (tile.X - _options.Width * 0.5) * _spacing;
+	spans.clear();
+	for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+	{
+		const auto y0 = _options.CenterY + (y - _options.Height * 0.5) * _spacing;
+		Kernels::Span span;
+		span.Output = band.Iterations.data() + static_cast<size_t>(y - band.Y) * _options.Width + tile.X;
+		span.Count = tile.Width;
+		span.X0 = x0.Hi;
+		span.X0Low = x0.Lo;
+		span.XStep = _spacing;
+		span.Y = y0.Hi;
+		span.YLow = y0.Lo;
+		span.Iterations = _options.Iterations;
+		span.CheckPeriodicity = _options.Periodicity;
+		span.PeriodicityTolerance = PeriodicityTolerance;
+		spans.push_back(span);
+	}
+
+	Kernels::SpanStats spanStats;
+	const auto& functions = Kernels::Active().For(precision);
+	if (_options.Julia)
+	{
+		// The negative sign is intentional, the window flips c the same way
+		functions.JuliaStream(spans.data(), spans.size(), _options.Julia->first, -_options.Julia->second, spanStats);
+	}
+	else
+	{
+		functions.MandelbrotStream(spans.data(), spans.size(), spanStats);
+	}
+	stats.LaneIterations += spanStats.LaneIterations;
+	stats.VectorIterations += spanStats.VectorIterations * functions.Width;
+	stats.SavedIterations += spanStats.SavedIterations;
+	stats.SkippedPixels += spanStats.SkippedPixels;
+}
+
+auto Renderer::ChoosePrecision() const -> Kernels::Precision
+{
+	const double halfWidth = _options.Width * 0.5 * _spacing;
+	const double halfHeight = _options.Height * 0.5 * _spacing;
+	const double corner = std::max(std::abs(_options.CenterX.ToDouble()) + halfWidth,
+	                               std::abs(_options.CenterY.ToDouble()) + halfHeight);
+	return PrecisionFor(std::clamp(corner, 2.0, OutsideRadius));
+}
+
+auto Renderer::PrecisionFor(double extent) const -> Kernels::Precision
+{
+	if (_spacing < DoubleGuardBand * extent * std::numeric_limits<double>::epsilon())
+	{
+		return Kernels::Precision::DoubleDouble;
+	}
+	if (_options.Iterations >= MaxFloatIterations)
+	{
+		return Kernels::Precision::Double;
+	}
+	return _spacing >= FloatGuardBand * extent * std::numeric_limits<float>::epsilon()
+		       ? Kernels::Precision::Float
+		       : Kernels::Precision::Double;
+}
+
+auto Renderer::TilePrecision(const Tile& tile) const -> Kernels::Precision
+{
+	if (_options.Precision)
+	{
+		return _precision;
+	}
+
+	// Distance of the tile's closest point to the origin along each axis
+	const auto nearest = [](double a, double b)
+	{
+		return a * b <= 0.0 ? 0.0 : std::min(std::abs(a), std::abs(b));
+	};
+	const double left = _options.CenterX.ToDouble() + (tile.X - _options.Width * 0.5) * _spacing;
+	const double top = _options.CenterY.ToDouble() + (tile.Y - _options.Height * 0.5) * _spacing;
+	const double right = left + tile.Width * _spacing, bottom = top + tile.Height * _spacing;
+	const double x = nearest(left, right);
+	const double y = nearest(top, bottom);
+	if (x * x + y * y > OutsideRadius * OutsideRadius)
+	{
+		return Kernels::Precision::Float;
+	}
+
+	// The view's rule on the tile's own coordinates, never more than the view needs
+	const double farthest = std::max({std::abs(left), std::abs(right), std::abs(top), std::abs(bottom)});
+	return std::min(PrecisionFor(std::clamp(farthest, 2.0, OutsideRadius)), _precision);
+}
+}
@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "ComputeHosts/TileScheduler.h"
+#include "ImageWriter.h"
+#include "Kernels/Kernels.h"
+#include "Options.h"
+#include "OutputStage.h"
+#include "Palette.h"
+
+namespace Se::Offline
+{
+struct RenderStats
+{
+	double Seconds = 0.0;
+	size_t Tiles = 0;
+	size_t StolenTiles = 0;
+	size_t LaneIterations = 0;
+	size_t VectorIterations = 0;
+	size_t SavedIterations = 0;
+	size_t SkippedPixels = 0;
+	std::array<size_t, static_cast<size_t>(Kernels::Precision::Count)> PrecisionTiles{};
+};
+
+// Computes the image one band of tile rows at a time and hands each to the output stage, which
+// colours, encodes and writes it while the next is computed. Only the output stage's few bands
+// are ever held, so memory stays the same from a thumbnail to a gigapixel image.
+class Renderer
+{
+public:
+	Renderer(const Options& options, const Palette& palette);
+
+	auto Render(ImageWriter& writer) -> bool;
+
+	auto Stats() const -> const RenderStats&;
+	auto Output() const -> const OutputStats&;
+	// Precision the view asks for. Tiles closer to the origin may take a cheaper one, and tiles
+	// outside the escape radius take float.
+	auto ViewPrecision() const -> Kernels::Precision;
+
+	// The same margins CpuHost::ChoosePrecision keeps, see there
+	static constexpr double FloatGuardBand = 1024.0;
+	static constexpr double DoubleGuardBand = 1024.0;
+	static constexpr double OutsideRadius = 4.0;
+	static constexpr int64_t MaxFloatIterations = int64_t(1) << 24;
+	static constexpr double PeriodicityTolerance = 1e-10;
+
+private:
+	void ComputeBand(Band& band);
+	void ComputeTile(const Tile& tile, Band& band, std::vector<Kernels::Span>& spans, RenderStats& stats);
+
+	auto ChoosePrecision() const -> Kernels::Precision;
+	// The guard band rule for coordinates up to extent
+	auto PrecisionFor(double extent) const -> Kernels::Precision;
+	auto TilePrecision(const Tile& tile) const -> Kernels::Precision;
+
+private:
+	const Options& _options;
+	const Palette& _palette;
+
+	double _spacing;
+	Kernels::Precision _precision;
+
+	TileScheduler _scheduler;
+
+	RenderStats _stats;
+	OutputStats _output;
+	std::mutex _statsMutex;
+};
+}
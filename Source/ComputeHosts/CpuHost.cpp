@@ -1,14 +1,351 @@
 ﻿#include "ComputeHosts/CpuHost.h"
 
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+#include "ComputePool.h"
+#include "DoubleDouble.h"
 #include "PaletteManager.h"
 
 namespace Se
 {
-CpuHost::CpuHost(int simWidth, int simHeight) :
-	Host(HostType::Cpu, "CPU", simWidth, simHeight),
+void Worker::Compute(TileScheduler& scheduler)
+{
+	Tile tile;
+	bool stolen = false;
+	// Every worker gets a tile in even past the deadline, so a frame always moves the image on
+	while ((Stats.Tiles == 0 || !scheduler.Expired()) && scheduler.Next(Index, tile, stolen))
+	{
+		const auto start = std::chrono::steady_clock::now();
+		ComputeTile(tile);
+		Stats.BusySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		Stats.Tiles++;
+		if (stolen)
+		{
+			Stats.StolenTiles++;
+		}
+		if (Finished)
+		{
+			Finished(tile);
+		}
+	}
+}
+
+void Worker::ComputeTile(const Tile& tile)
+{
+	_tilePrecision = ChooseTilePrecision(tile);
+	Stats.PrecisionTiles[static_cast<size_t>(_tilePrecision)]++;
+
+	if (States != nullptr)
+	{
+		ComputeStale(tile);
+		return;
+	}
+
+	if (Subdivide && Step == 1)
+	{
+		ComputeSubdivided(tile);
+		return;
+	}
+
+	const int yEnd = tile.Y + tile.Height;
+	for (int y = tile.Y; y < yEnd; y += Step)
+	{
+		// Rows shared with the previous pass already have every other pixel
+		const bool skipEven = Refine && y % (2 * Step) == 0;
+		const int first = tile.X + (skipEven ? Step : 0);
+		const int stride = skipEven ? 2 * Step : Step;
+		const int count = (tile.X + tile.Width - first + stride - 1) / stride;
+		if (count > 0)
+		{
+			QueueRun(first, y, count, stride);
+		}
+	}
+	FlushRuns();
+
+	if (Step > 1)
+	{
+		FillBlocks(tile);
+	}
+}
+
+auto Worker::ChooseTilePrecision(const Tile& tile) const -> Kernels::Precision
+{
+	if (!AutomaticPrecision)
+	{
+		return Precision;
+	}
+
+	const double left = FractalTL.x + tile.X * XScale, right = FractalTL.x + (tile.X + tile.Width) * XScale;
+	const double top = FractalTL.y + tile.Y * YScale, bottom = FractalTL.y + (tile.Y + tile.Height) * YScale;
+
+	// Distance of the tile's closest point to the origin along each axis
+	const auto nearest = [](double a, double b)
+	{
+		return a * b <= 0.0 ? 0.0 : std::min(std::abs(a), std::abs(b));
+	};
+	const double x = nearest(left, right);
+	const double y = nearest(top, bottom);
+	const double radius = CpuHost::OutsideRadius;
+	if (x * x + y * y > radius * radius)
+	{
+		return Kernels::Precision::Float;
+	}
+
+	// The frame's rule on the tile's own coordinates. The frame went by the largest coordinate in
+	// view, so tiles closer to the origin can only come out cheaper.
+	const double farthest = std::max({std::abs(left), std::abs(right), std::abs(top), std::abs(bottom)});
+	const double spacing = std::min(std::abs(XScale), std::abs(YScale));
+	const auto precision = CpuHost::PrecisionFor(std::clamp(farthest, 2.0, radius), spacing, Iterations, Precision);
+	// Hosts with a reference orbit take perturbation wherever double-double would do
+	return precision == Kernels::Precision::DoubleDouble && Precision == Kernels::Precision::Perturbation
+		       ? Kernels::Precision::Perturbation
+		       : precision;
+}
+
+void Worker::ComputeStale(const Tile& tile)
+{
+	const int xEnd = tile.X + tile.Width;
+
+	if (Subdivide)
+	{
+		bool allStale = true;
+		for (int y = tile.Y; y < tile.Y + tile.Height && allStale; y++)
+		{
+			const PixelState* row = States + y * SimWidth;
+			allStale = std::find(row + tile.X, row + xEnd, PixelState::Fresh) == row + xEnd;
+		}
+		if (allStale)
+		{
+			ComputeSubdivided(tile);
+			for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+			{
+				std::fill_n(States + y * SimWidth + tile.X, tile.Width, PixelState::Fresh);
+			}
+			return;
+		}
+	}
+
+	for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+	{
+		PixelState* row = States + y * SimWidth;
+		int x = tile.X;
+		while (x < xEnd)
+		{
+			if (row[x] == PixelState::Fresh)
+			{
+				x++;
+				continue;
+			}
+			const int first = x;
+			while (x < xEnd && row[x] != PixelState::Fresh)
+			{
+				row[x++] = PixelState::Fresh;
+			}
+			QueueRun(first, y, x - first, 1);
+		}
+	}
+	FlushRuns();
+}
+
+void Worker::ComputeSubdivided(const Tile& tile)
+{
+	const Rect whole{tile.X, tile.Y, tile.X + tile.Width - 1, tile.Y + tile.Height - 1};
+	QueueRun(whole.X0, whole.Y0, tile.Width, 1);
+	if (whole.Y1 > whole.Y0)
+	{
+		QueueRun(whole.X0, whole.Y1, tile.Width, 1);
+	}
+	for (int y = whole.Y0 + 1; y < whole.Y1; y++)
+	{
+		QueueRun(whole.X0, y, whole.X1 > whole.X0 ? 2 : 1, std::max(1, whole.X1 - whole.X0));
+	}
+	FlushRuns();
+
+	// Level by level, so all borders a level needs are computed in one batch
+	std::vector<Rect> level = {whole}, next;
+	while (!level.empty())
+	{
+		next.clear();
+		for (const auto& r : level)
+		{
+			SubdivideRect(r, next);
+		}
+		FlushRuns();
+		std::swap(level, next);
+	}
+}
+
+void Worker::SubdivideRect(const Rect& r, std::vector<Rect>& next)
+{
+	const int innerWidth = r.X1 - r.X0 - 1;
+	const int innerHeight = r.Y1 - r.Y0 - 1;
+	if (innerWidth <= 0 || innerHeight <= 0)
+	{
+		return;
+	}
+
+	const int value = FractalArray[r.Y0 * SimWidth + r.X0];
+	bool uniform = true;
+	for (int x = r.X0; x <= r.X1 && uniform; x++)
+	{
+		uniform = FractalArray[r.Y0 * SimWidth + x] == value && FractalArray[r.Y1 * SimWidth + x] == value;
+	}
+	for (int y = r.Y0 + 1; y < r.Y1 && uniform; y++)
+	{
+		uniform = FractalArray[y * SimWidth + r.X0] == value && FractalArray[y * SimWidth + r.X1] == value;
+	}
+
+	if (uniform)
+	{
+		for (int y = r.Y0 + 1; y < r.Y1; y++)
+		{
+			std::fill_n(FractalArray + y * SimWidth + r.X0 + 1, innerWidth, value);
+		}
+		Stats.FilledPixels += static_cast<size_t>(innerWidth) * innerHeight;
+		return;
+	}
+
+	if (innerWidth < CpuHost::MinSubdivisionSize || innerHeight < CpuHost::MinSubdivisionSize)
+	{
+		for (int y = r.Y0 + 1; y < r.Y1; y++)
+		{
+			QueueRun(r.X0 + 1, y, innerWidth, 1);
+		}
+		return;
+	}
+
+	const int midX = (r.X0 + r.X1) / 2;
+	const int midY = (r.Y0 + r.Y1) / 2;
+	QueueRun(r.X0 + 1, midY, innerWidth, 1);
+	for (int y = r.Y0 + 1; y < r.Y1; y++)
+	{
+		if (y != midY)
+		{
+			QueueRun(midX, y, 1, 1);
+		}
+	}
+
+	next.push_back({r.X0, r.Y0, midX, midY});
+	next.push_back({midX, r.Y0, r.X1, midY});
+	next.push_back({r.X0, midY, midX, r.Y1});
+	next.push_back({midX, midY, r.X1, r.Y1});
+}
+
+void Worker::ComputeRuns(const std::vector<Run>& runs)
+{
+	for (const auto& run : runs)
+	{
+		ComputeSpan(run.X, run.Y, run.Count, run.Stride);
+	}
+}
+
+void Worker::QueueRun(int x, int y, int count, int stride)
+{
+	if (Streaming)
+	{
+		_runs.push_back({x, y, count, stride});
+		return;
+	}
+	ComputeSpan(x, y, count, stride);
+}
+
+void Worker::FlushRuns()
+{
+	if (_runs.empty())
+	{
+		return;
+	}
+	ComputeRuns(_runs);
+	_runs.clear();
+}
+
+auto Worker::MakeSpan(int x, int y, int count, int stride) const -> Kernels::Span
+{
+	Kernels::Span span;
+	span.Output = FractalArray + y * SimWidth + x;
+	span.Count = count;
+	span.Stride = stride;
+	const DoubleDouble x0 = DoubleDouble(FractalTL.x, FractalTLLow.x) + DoubleDouble(x * XScale);
+	const DoubleDouble y0 = DoubleDouble(FractalTL.y, FractalTLLow.y) + DoubleDouble(y * YScale);
+	span.X0 = x0.Hi;
+	span.X0Low = x0.Lo;
+	span.XStep = XScale * stride;
+	span.Y = y0.Hi;
+	span.YLow = y0.Lo;
+	span.Exponent = Exponent;
+	span.Iterations = static_cast<int64_t>(Iterations);
+	span.CheckPeriodicity = CheckPeriodicity;
+	span.PeriodicityTolerance = PeriodicityTolerance;
+	return span;
+}
+
+auto Worker::MakeSpans(const std::vector<Run>& runs) -> const std::vector<Kernels::Span>&
+{
+	_spans.clear();
+	for (const auto& run : runs)
+	{
+		_spans.push_back(MakeSpan(run.X, run.Y, run.Count, run.Stride));
+	}
+	return _spans;
+}
+
+auto Worker::Functions() const -> const Kernels::KernelFunctions&
+{
+	return Kernels::Active().For(_tilePrecision);
+}
+
+auto Worker::TilePrecision() const -> Kernels::Precision
+{
+	return _tilePrecision;
+}
+
+void Worker::AddStats(const Kernels::SpanStats& stats)
+{
+	Stats.SavedIterations += stats.SavedIterations;
+	Stats.SkippedPixels += stats.SkippedPixels;
+	Stats.LaneIterations += stats.LaneIterations;
+	Stats.VectorIterations += stats.VectorIterations * Functions().Width;
+	Stats.GlitchedPixels += stats.GlitchedPixels;
+	Stats.ApproximatedIterations += stats.ApproximatedIterations;
+	Stats.ExtendedIterations += stats.ExtendedIterations;
+}
+
+void Worker::FillBlocks(const Tile& tile)
+{
+	// Spread every sample over its Step x Step block so the coarse pass reads as a
+	// low resolution image. Later passes overwrite the block with real values.
+	const int xEnd = tile.X + tile.Width;
+	const int yEnd = tile.Y + tile.Height;
+	for (int y = tile.Y; y < yEnd; y++)
+	{
+		const int sampleRow = y - (y - tile.Y) % Step;
+		int* row = FractalArray + y * SimWidth;
+		const int* samples = FractalArray + sampleRow * SimWidth;
+		for (int x = tile.X; x < xEnd; x++)
+		{
+			row[x] = samples[x - (x - tile.X) % Step];
+		}
+	}
+}
+
+CpuHost::CpuHost(int simWidth, int simHeight, WorkerFactory workerFactory) :
+	CpuHost(HostType::Cpu, "CPU", simWidth, simHeight, std::move(workerFactory))
+{
+}
+
+CpuHost::CpuHost(HostType type, std::string name, int simWidth, int simHeight, WorkerFactory workerFactory) :
+	Host(type, std::move(name), simWidth, simHeight),
+	_workerFactory(std::move(workerFactory)),
 	_vertexArray(sf::PrimitiveType::Points, SimWidth() * SimHeight()),
-	_fractalArray(new int[SimWidth() * SimHeight()])
+	_fractalArray(SimWidth() * SimHeight()),
+	_previewArray(SimWidth() * SimHeight()),
+	_previewStates(SimWidth() * SimHeight(), PixelState::Missing)
 {
+	_states.assign(SimWidth() * SimHeight(), PixelState::Missing);
+	_supportsSubdivision = _workerFactory()->SupportsSubdivision();
+
 	for (size_t i = 0; i < _vertexArray.getVertexCount(); i++)
 	{
 		_vertexArray[i].position = sf::Vector2f(static_cast<float>(std::floor(i % SimWidth())),
@@ -19,13 +356,7 @@ CpuHost::CpuHost(int simWidth, int simHeight) :
 
 CpuHost::~CpuHost()
 {
-	for (auto& worker : _workers)
-	{
-		worker->Alive = false;
-		worker->CvStart.notify_all();
-		if (worker->Thread.joinable()) worker->Thread.join();
-	}
-	_workers.clear();
+	CancelComputation();
 }
 
 void CpuHost::OnRender(Scene& scene)
@@ -35,14 +366,36 @@ void CpuHost::OnRender(Scene& scene)
 	scene.DeactivateScreenSpaceDrawing();
 }
 
-void CpuHost::AddWorker(std::unique_ptr<Worker> worker)
+void CpuHost::CancelComputation()
+{
+	if (!_frame.valid())
+	{
+		return;
+	}
+	// Too late to cancel, keep the frame
+	if (_frame.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		FinishFrame();
+		return;
+	}
+
+	_cancelled = true;
+	_scheduler.Cancel();
+	_frame.get();
+	_cancelled = false;
+
+	// Stale tiles keep their state and are picked up again. A frame over the whole image left
+	// no view behind to reuse, it starts over.
+	if (_frameReusing)
+	{
+		_pendingTiles.insert(_pendingTiles.begin(), _frameTiles.begin(), _frameTiles.end());
+	}
+	RequestImageRendering();
+}
+
+auto CpuHost::Computing() const -> bool
 {
-	worker->WorkerComplete = &_nWorkerComplete;
-	worker->FractalArray = _fractalArray;
-	worker->SimWidth = SimWidth();
-	worker->Alive = true;
-	worker->Thread = std::thread(&Worker::Compute, &*worker);
-	_workers.emplace_back(std::move(worker));
+	return _frame.valid();
 }
 
 auto CpuHost::Workers() -> std::vector<std::unique_ptr<Worker>>&
@@ -55,76 +408,1116 @@ auto CpuHost::Workers() const -> const std::vector<std::unique_ptr<Worker>>&
 	return const_cast<CpuHost&>(*this).Workers();
 }
 
-void CpuHost::ComputeImage()
+auto CpuHost::FrameStats() const -> const std::vector<WorkerStats>&
 {
-	const double imageSectionWidth = static_cast<double>(SimWidth()) / static_cast<double>(_workers.size());
-	const double fractalSectionWidth = (SimBox().BottomRight.x - SimBox().TopLeft.x) / static_cast<double>(_workers.
-		size());
+	return _frameStats;
+}
 
-	_nWorkerComplete = 0;
+auto CpuHost::TileSize() const -> int
+{
+	return _tileSize;
+}
 
-	const auto simBox = SimBox();
-	const auto tl = simBox.TopLeft;
-	const auto br = simBox.BottomRight;
-	const auto simHeight = SimHeight();
-	const auto iterations = ComputeIterations();
+void CpuHost::SetTileSize(int tileSize)
+{
+	// Keep tiles on the coarsest progressive grid so passes never cross tile borders
+	const int alignment = ProgressiveSteps.front();
+	CancelComputation();
+	_tileSize = std::max(alignment, tileSize / alignment * alignment);
+}
 
-	for (size_t i = 0; i < _workers.size(); i++)
-	{
-		_workers[i]->ImageTL = sf::Vector2(imageSectionWidth * i, 0.0);
-		_workers[i]->ImageBR = sf::Vector2<double>(imageSectionWidth * static_cast<double>(i + 1), simHeight);
-		_workers[i]->FractalTL = sf::Vector2(tl.x + i * fractalSectionWidth, tl.y);
-		_workers[i]->FractalBR = sf::Vector2(tl.x + fractalSectionWidth * static_cast<double>(i + 1), br.y);
-		_workers[i]->Iterations = iterations;
+auto CpuHost::Progressive() const -> bool
+{
+	return _progressive;
+}
 
-		std::unique_lock lm(_workers[i]->Mutex);
-		_workers[i]->CvStart.notify_one();
-	}
+void CpuHost::SetProgressive(bool progressive)
+{
+	// A frame in flight was dispatched for the old mode and would finish with the wrong pass
+	CancelComputation();
+	_progressive = progressive;
+	_progressivePass = 0;
+}
+
+auto CpuHost::ProgressivePass() const -> int
+{
+	return _progressivePass;
+}
+
+void CpuHost::Invalidate()
+{
+	CancelComputation();
+	_bufferBox.reset();
+}
+
+auto CpuHost::Panned() const -> bool
+{
+	return _panned;
+}
+
+auto CpuHost::Reprojected() const -> bool
+{
+	return _reprojected;
+}
+
+auto CpuHost::PendingTiles() const -> size_t
+{
+	return _pendingTiles.size();
+}
+
+auto CpuHost::CacheKey() const -> const std::optional<uint64_t>&
+{
+	return _cacheKey;
+}
+
+void CpuHost::SetCacheKey(std::optional<uint64_t> key)
+{
+	_cacheKey = key;
+}
+
+auto CpuHost::CachedPixels() const -> size_t
+{
+	return _cachedPixels;
+}
+
+auto CpuHost::ReprojectionTolerance() const -> int
+{
+	return _reprojectionTolerance;
+}
+
+void CpuHost::SetReprojectionTolerance(int tolerance)
+{
+	_reprojectionTolerance = tolerance;
+}
+
+auto CpuHost::SupportsSubdivision() const -> bool
+{
+	return _supportsSubdivision;
+}
+
+auto CpuHost::Subdivision() const -> bool
+{
+	return _subdivision;
+}
+
+void CpuHost::SetSubdivision(bool subdivision)
+{
+	_subdivision = subdivision;
+	_subdivisionMismatches = 0;
+}
+
+auto CpuHost::ValidateSubdivision() const -> bool
+{
+	return _validateSubdivision;
+}
+
+void CpuHost::SetValidateSubdivision(bool validate)
+{
+	_validateSubdivision = validate;
+	_subdivisionMismatches = 0;
+}
+
+auto CpuHost::SubdivisionMismatches() const -> size_t
+{
+	return _subdivisionMismatches;
+}
 
-	while (_nWorkerComplete < _workers.size()) // Wait for all workers to complete
+auto CpuHost::FilledPixels() const -> size_t
+{
+	size_t filled = 0;
+	for (const auto& stats : _frameStats)
 	{
+		filled += stats.FilledPixels;
 	}
+	return filled;
 }
 
-void CpuHost::RenderImage()
+auto CpuHost::Periodicity() const -> bool
 {
-	const auto* const colorPal = PaletteManager::Instance().DesiredPixelPtr();
+	return _periodicity;
+}
 
-	const auto simWidth = SimWidth();
-	const auto simHeight = SimHeight();
-	const auto iterations = ComputeIterations();
+void CpuHost::SetPeriodicity(bool periodicity)
+{
+	_periodicity = periodicity;
+}
 
-	for (int y = 0; y < simHeight; y++)
-	{
-		for (int x = 0; x < simWidth; x++)
-		{
-			const int i = _fractalArray[y * simWidth + x];
-			const float offset = static_cast<float>(i) / static_cast<float>(iterations) * static_cast<float>(
-				PaletteManager::PaletteWidth - 1);
+auto CpuHost::PeriodicityTolerance() const -> double
+{
+	return _periodicityTolerance;
+}
 
+void CpuHost::SetPeriodicityTolerance(double tolerance)
+{
+	_periodicityTolerance = tolerance;
+}
 
-			memcpy(&_vertexArray[y * simWidth + x].color, &colorPal[static_cast<int>(offset) * 4],
-			       sizeof(sf::Uint8) * 3);
-		}
+auto CpuHost::SavedIterations() const -> size_t
+{
+	size_t saved = 0;
+	for (const auto& stats : _frameStats)
+	{
+		saved += stats.SavedIterations;
 	}
+	return saved;
 }
 
-void CpuHost::Resize(int width, int height)
+auto CpuHost::SkippedPixels() const -> size_t
 {
-	_vertexArray.resize(width * height);
-	for (size_t i = 0; i < _vertexArray.getVertexCount(); i++)
+	size_t skipped = 0;
+	for (const auto& stats : _frameStats)
 	{
-		_vertexArray[i].position = sf::Vector2f(static_cast<float>(std::floor(i % width)),
-		                                        static_cast<float>(std::floor(i / width)));
-		_vertexArray[i].color = sf::Color{0, 0, 0, 255};
+		skipped += stats.SkippedPixels;
 	}
+	return skipped;
+}
 
-	//delete[] _fractalArray;
-	_fractalArray = new int[width * height];
-	for (const auto& worker : _workers)
+auto CpuHost::Streaming() const -> bool
+{
+	return _streaming;
+}
+
+void CpuHost::SetStreaming(bool streaming)
+{
+	_streaming = streaming;
+}
+
+auto CpuHost::LaneUtilisation() const -> double
+{
+	size_t lane = 0, vector = 0;
+	for (const auto& stats : _frameStats)
 	{
-		worker->FractalArray = _fractalArray;
-		worker->SimWidth = width;
+		lane += stats.LaneIterations;
+		vector += stats.VectorIterations;
 	}
+	return vector > 0 ? static_cast<double>(lane) / static_cast<double>(vector) : 0.0;
+}
+
+void CpuHost::RunLaneBenchmark()
+{
+	CancelComputation();
+	SyncWorkers(ComputePool::Instance().ThreadCount());
+
+	// The workers' counters are scratch space here, FrameStats keeps the last frame's
+	const auto run = [&](bool streaming, double& seconds, double& utilisation)
+	{
+		SetupWorkers(_previewArray.data(), SimBox());
+		PrepareWorkers(SimBox());
+		for (auto& worker : _workers)
+		{
+			worker->Streaming = streaming;
+			worker->Subdivide = false;
+		}
+		seconds = Dispatch({{0, 0, SimWidth(), SimHeight()}}, _tileSize);
+
+		size_t lane = 0, vector = 0;
+		for (const auto& worker : _workers)
+		{
+			lane += worker->Stats.LaneIterations;
+			vector += worker->Stats.VectorIterations;
+		}
+		utilisation = vector > 0 ? static_cast<double>(lane) / static_cast<double>(vector) : 0.0;
+	};
+
+	LaneBenchmark result;
+	run(false, result.GroupedSeconds, result.GroupedUtilisation);
+	run(true, result.StreamingSeconds, result.StreamingUtilisation);
+	_laneBenchmark = result;
+}
+
+auto CpuHost::LastLaneBenchmark() const -> const std::optional<LaneBenchmark>&
+{
+	return _laneBenchmark;
+}
+
+auto CpuHost::Precision() const -> PrecisionMode
+{
+	return _precisionMode;
+}
+
+void CpuHost::SetPrecision(PrecisionMode mode)
+{
+	_precisionMode = mode;
+}
+
+auto CpuHost::ActivePrecision() const -> Kernels::Precision
+{
+	return _precision;
+}
+
+auto CpuHost::PrecisionTiles(Kernels::Precision precision) const -> size_t
+{
+	size_t tiles = 0;
+	for (const auto& stats : _frameStats)
+	{
+		tiles += stats.PrecisionTiles[static_cast<size_t>(precision)];
+	}
+	return tiles;
+}
+
+auto CpuHost::TileCount() const -> size_t
+{
+	return _scheduler.TileCount();
+}
+
+auto CpuHost::FinishedTiles() const -> size_t
+{
+	size_t tiles = 0;
+	for (const auto& stats : _frameStats)
+	{
+		tiles += stats.Tiles;
+	}
+	return tiles;
+}
+
+auto CpuHost::CarriedTiles() const -> size_t
+{
+	return _carryTiles.size();
+}
+
+auto CpuHost::FrameSeconds() const -> double
+{
+	return _frameSeconds;
+}
+
+auto CpuHost::Utilisation(size_t workerIndex) const -> double
+{
+	if (_frameSeconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return _frameStats[workerIndex].BusySeconds / _frameSeconds;
+}
+
+void CpuHost::ComputeImage()
+{
+	if (_frame.valid())
+	{
+		if (!ComputationRequested())
+		{
+			// Present what the workers have so far until the frame is in
+			if (_frame.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				ContinueComputation();
+				RequestImageRendering();
+				return;
+			}
+			FinishFrame();
+			return;
+		}
+		// Anything that changes the image cancels on its own, this is a request to redo it
+		CancelComputation();
+	}
+
+	const auto simBox = SimBox();
+	const auto iterations = ComputeIterations();
+
+	if (ComputationRequested())
+	{
+		_progressivePass = 0;
+		_panned = false;
+		_reprojected = false;
+		_pendingTiles.clear();
+		_carryTiles.clear();
+		_cachedPixels = 0;
+
+		// Pixels from the other precision would show as seams next to new ones
+		const auto precision = ChoosePrecision(simBox, iterations);
+		if (precision != _precision)
+		{
+			_precision = precision;
+			_bufferBox.reset();
+		}
+
+		// Shifts and reprojections are worked out in double, which cannot place pixels this deep
+		const bool deep = _precision == Kernels::Precision::DoubleDouble ||
+			_precision == Kernels::Precision::Perturbation;
+		if (_bufferBox && iterations == _bufferIterations && !deep)
+		{
+			_panned = ShiftBuffer(simBox);
+			_reprojected = !_panned && ReprojectBuffer(simBox);
+		}
+
+		// The view, or what a move uncovered, may have been computed before
+		const bool moved = _panned || _reprojected;
+		if (const auto grid = CacheGridFor(simBox, iterations))
+		{
+			if (!moved)
+			{
+				std::fill(_states.begin(), _states.end(), PixelState::Missing);
+			}
+			_cachedPixels = LoadCachedTiles(*grid);
+		}
+
+		if (moved)
+		{
+			_bufferExact = _bufferExact && _panned;
+			QueueStaleTiles();
+		}
+		else if (_cachedPixels > 0)
+		{
+			// Only what the cache lacks is computed
+			_bufferBox = simBox;
+			_bufferIterations = iterations;
+			_bufferExact = true;
+			QueueStaleTiles();
+		}
+		else
+		{
+			_bufferBox.reset();
+		}
+	}
+
+	SyncWorkers(ComputePool::Instance().ThreadCount());
+
+	// A reused buffer only needs its stale tiles. Tiles without any preview go out at once, the
+	// rest are spread over the next frames with the preview on screen in the meantime.
+	const bool reusing = _bufferBox.has_value();
+	int step = 1;
+	std::vector<Tile> tiles;
+	if (reusing)
+	{
+		const size_t batch = _workers.size() * ReprojectionTilesPerWorker;
+		while (!_pendingTiles.empty() && (tiles.size() < batch || TileHasMissing(_pendingTiles.front())))
+		{
+			tiles.push_back(_pendingTiles.front());
+			_pendingTiles.pop_front();
+		}
+	}
+	else
+	{
+		// Finish what the budget cut off before going over the image again
+		if (!_carryTiles.empty())
+		{
+			tiles = std::move(_carryTiles);
+			_carryTiles.clear();
+		}
+		else
+		{
+			tiles = {{0, 0, SimWidth(), SimHeight()}};
+		}
+		step = _progressive ? ProgressiveSteps[_progressivePass] : 1;
+	}
+
+	if (reusing && tiles.empty())
+	{
+		// The cache had all of it
+		RequestImageRendering();
+		return;
+	}
+
+	SetupWorkers(_fractalArray.data(), simBox);
+	for (auto& worker : _workers)
+	{
+		worker->Step = step;
+		worker->Refine = _progressive && _progressivePass > 0;
+		worker->States = reusing ? _states.data() : nullptr;
+	}
+
+	// The workers have their copy of every setting, the frame itself runs in the background
+	// so a slow one never holds up the UI
+	_frameBox = simBox;
+	_frameIterations = iterations;
+	_frameTiles = tiles;
+	_frameStep = step;
+	_frameReusing = reusing;
+	_frameFocus = FocusPoint();
+	// Keyed now, settings may change before the frame is in
+	_frameGrid = CacheGridFor(simBox, iterations);
+	// The last chance to read the buffer before the workers start writing it
+	_presented = _fractalArray;
+	_finishedTiles.clear();
+	// The frame may have taken several budgets, the check covers all of it
+	const bool validate = _subdivision && _validateSubdivision && step == 1 && !reusing;
+	_frame = std::async(std::launch::async, [this, simBox, tiles, tileSize = _tileSize, budget = FrameBudget(), validate]
+	{
+		PrepareWorkers(simBox);
+		const auto start = std::chrono::steady_clock::now();
+		Dispatch(tiles, tileSize, budget);
+
+		// The frame is thrown away, its queues were emptied and most tiles never computed
+		FrameResult result;
+		if (Cancelled())
+		{
+			return result;
+		}
+
+		// Only the tiles that were computed have anything to finish
+		result.Remaining = _scheduler.Remaining();
+		FinishTiles(_fractalArray.data(), _scheduler.Issued());
+		if (validate && result.Remaining.empty())
+		{
+			const auto mismatches = ValidateFrame(simBox, {{0, 0, SimWidth(), SimHeight()}}, tileSize);
+			if (!Cancelled())
+			{
+				result.Mismatches = mismatches;
+			}
+		}
+		result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	});
+	ContinueComputation();
+}
+
+void CpuHost::FinishFrame()
+{
+	auto result = _frame.get();
+	_frameSeconds = result.Seconds;
+	_frameStats.clear();
+	for (const auto& worker : _workers)
+	{
+		_frameStats.push_back(worker->Stats);
+	}
+
+	if (!result.Remaining.empty())
+	{
+		// Out of budget, show what is done and carry on with the rest next frame
+		if (_frameReusing)
+		{
+			_pendingTiles.insert(_pendingTiles.begin(), result.Remaining.begin(), result.Remaining.end());
+		}
+		else
+		{
+			_carryTiles = std::move(result.Remaining);
+		}
+		ContinueComputation();
+		RequestImageRendering();
+		return;
+	}
+
+	if (result.Mismatches)
+	{
+		_subdivisionMismatches = *result.Mismatches;
+	}
+
+	if (_frameStep > 1)
+	{
+		// Present this pass now and refine it next frame
+		_progressivePass++;
+		ContinueComputation();
+	}
+	else if (_frameReusing)
+	{
+		if (!_pendingTiles.empty())
+		{
+			ContinueComputation();
+		}
+		else if (_frameGrid && _bufferExact)
+		{
+			StoreCachedTiles(*_frameGrid);
+		}
+	}
+	else
+	{
+		_bufferBox = _frameBox;
+		_bufferIterations = _frameIterations;
+		_bufferExact = true;
+		std::fill(_states.begin(), _states.end(), PixelState::Fresh);
+		if (_frameGrid)
+		{
+			StoreCachedTiles(*_frameGrid);
+		}
+	}
+	RequestImageRendering();
+}
+
+void CpuHost::RenderImage()
+{
+	const auto* const colorPal = PaletteManager::Instance().DesiredPixelPtr();
+
+	const auto simWidth = SimWidth();
+	const auto simHeight = SimHeight();
+	const auto iterations = ComputeIterations();
+
+	// The workers are still writing the frame's buffer, show the tiles they are done with
+	const int* fractalArray = _fractalArray.data();
+	if (_frame.valid())
+	{
+		std::vector<std::pair<Tile, std::vector<int>>> finished;
+		{
+			std::scoped_lock lock(_presentMutex);
+			finished.swap(_finishedTiles);
+		}
+		for (const auto& [tile, pixels] : finished)
+		{
+			for (int y = 0; y < tile.Height; y++)
+			{
+				std::copy_n(pixels.data() + y * tile.Width, tile.Width, &_presented[(tile.Y + y) * simWidth + tile.X]);
+			}
+		}
+		fractalArray = _presented.data();
+	}
+
+	for (int y = 0; y < simHeight; y++)
+	{
+		for (int x = 0; x < simWidth; x++)
+		{
+			// Frames still computing may hold pixels that are glitched for now
+			const int i = std::max(fractalArray[y * simWidth + x], 0);
+			const float offset = static_cast<float>(i) / static_cast<float>(iterations) * static_cast<float>(
+				PaletteManager::PaletteWidth - 1);
+
+
+			memcpy(&_vertexArray[y * simWidth + x].color, &colorPal[static_cast<int>(offset) * 4],
+			       sizeof(sf::Uint8) * 3);
+		}
+	}
+}
+
+void CpuHost::PresentTile(const Tile& tile)
+{
+	std::vector<int> pixels(static_cast<size_t>(tile.Width) * tile.Height);
+	for (int y = 0; y < tile.Height; y++)
+	{
+		std::copy_n(&_fractalArray[(tile.Y + y) * SimWidth() + tile.X], tile.Width, pixels.data() + y * tile.Width);
+	}
+	std::scoped_lock lock(_presentMutex);
+	_finishedTiles.emplace_back(tile, std::move(pixels));
+}
+
+void CpuHost::Resize(int width, int height)
+{
+	CancelComputation();
+	_vertexArray.resize(width * height);
+	for (size_t i = 0; i < _vertexArray.getVertexCount(); i++)
+	{
+		_vertexArray[i].position = sf::Vector2f(static_cast<float>(std::floor(i % width)),
+		                                        static_cast<float>(std::floor(i / width)));
+		_vertexArray[i].color = sf::Color{0, 0, 0, 255};
+	}
+
+	_fractalArray.assign(width * height, 0);
+	_previewArray.assign(width * height, 0);
+	_states.assign(width * height, PixelState::Missing);
+	_previewStates.assign(width * height, PixelState::Missing);
+	// Tiles and passes of the old size would land outside the new buffers
+	_pendingTiles.clear();
+	_carryTiles.clear();
+	_progressivePass = 0;
+	_panned = false;
+	_reprojected = false;
+	_bufferBox.reset();
+}
+
+void CpuHost::SyncWorkers(size_t count)
+{
+	while (_workers.size() < count)
+	{
+		auto worker = _workerFactory();
+		worker->Index = _workers.size();
+		_workers.emplace_back(std::move(worker));
+	}
+	_workers.resize(count);
+}
+
+void CpuHost::SetupWorkers(int* fractalArray, const struct SimBox& simBox)
+{
+	// The spacing is worked out from the precise corners, their rounded difference is all noise
+	// once the view is narrower than a double step
+	const auto size = simBox.PreciseBottomRight - simBox.PreciseTopLeft;
+	for (auto& worker : _workers)
+	{
+		worker->FractalArray = fractalArray;
+		worker->SimWidth = SimWidth();
+		// Only tiles of the frame's own buffer are for the screen
+		worker->Finished = nullptr;
+		if (fractalArray == _fractalArray.data())
+		{
+			worker->Finished = [this](const Tile& tile) { PresentTile(tile); };
+		}
+		worker->FractalTL = simBox.TopLeft;
+		worker->FractalTLLow = simBox.PreciseTopLeft.Low();
+		worker->XScale = (size.x / static_cast<double>(SimWidth())).ToDouble();
+		worker->YScale = (size.y / static_cast<double>(SimHeight())).ToDouble();
+		worker->Exponent = 0;
+		worker->Iterations = ComputeIterations();
+		worker->Step = 1;
+		worker->Refine = false;
+		worker->States = nullptr;
+		worker->Subdivide = _subdivision && _supportsSubdivision;
+		worker->CheckPeriodicity = _periodicity;
+		worker->PeriodicityTolerance = _periodicityTolerance;
+		worker->Streaming = _streaming;
+		worker->Precision = _precision;
+		worker->AutomaticPrecision = _precisionMode == PrecisionMode::Automatic;
+		worker->Stats = {};
+	}
+}
+
+auto CpuHost::Cancelled() const -> bool
+{
+	return _cancelled;
+}
+
+auto CpuHost::Dispatch(const std::vector<Tile>& regions, int tileSize, double budget) -> double
+{
+	_scheduler.Schedule(regions, tileSize, _workers.size(), _frameFocus);
+	// A cancel that came in just before the tiles were queued found nothing to drop
+	if (_cancelled)
+	{
+		_scheduler.Cancel();
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	_scheduler.SetDeadline(budget > 0.0
+		                       ? std::optional(start + std::chrono::duration_cast<TileScheduler::Clock::duration>(
+			                       std::chrono::duration<double, std::milli>(budget)))
+		                       : std::nullopt);
+	ComputePool::Instance().Dispatch(_workers.size(), [this](size_t index)
+	{
+		_workers[index]->Compute(_scheduler);
+	}).Wait();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+auto CpuHost::ShiftBuffer(const struct SimBox& simBox) -> bool
+{
+	const auto& old = *_bufferBox;
+	const int width = SimWidth();
+	const int height = SimHeight();
+	const double xScale = (simBox.BottomRight.x - simBox.TopLeft.x) / static_cast<double>(width);
+	const double yScale = (simBox.BottomRight.y - simBox.TopLeft.y) / static_cast<double>(height);
+
+	// Same scale, measured as drift over the whole viewport
+	const double widthDrift = (old.BottomRight.x - old.TopLeft.x) - (simBox.BottomRight.x - simBox.TopLeft.x);
+	const double heightDrift = (old.BottomRight.y - old.TopLeft.y) - (simBox.BottomRight.y - simBox.TopLeft.y);
+	if (std::abs(widthDrift / xScale) > PixelTolerance || std::abs(heightDrift / yScale) > PixelTolerance)
+	{
+		return false;
+	}
+
+	// Whole pixel translation, new pixel (x, y) is old pixel (x + dx, y + dy)
+	const double xShift = (simBox.TopLeft.x - old.TopLeft.x) / xScale;
+	const double yShift = (simBox.TopLeft.y - old.TopLeft.y) / yScale;
+	const int dx = static_cast<int>(std::round(xShift));
+	const int dy = static_cast<int>(std::round(yShift));
+	if (std::abs(xShift - dx) > PixelTolerance || std::abs(yShift - dy) > PixelTolerance ||
+		std::abs(dx) >= width || std::abs(dy) >= height)
+	{
+		return false;
+	}
+
+	const int keptWidth = width - std::abs(dx);
+	const int destX = std::max(0, -dx);
+	const int srcX = std::max(0, dx);
+	const auto moveRow = [&](int y)
+	{
+		std::memmove(&_fractalArray[y * width + destX], &_fractalArray[(y + dy) * width + srcX],
+		             keptWidth * sizeof(int));
+		std::memmove(&_states[y * width + destX], &_states[(y + dy) * width + srcX],
+		             keptWidth * sizeof(PixelState));
+	};
+
+	// Walk rows away from the side they are read from so nothing is overwritten before it moves
+	const int keptFirst = std::max(0, -dy);
+	const int keptLast = std::min(height, height - dy);
+	if (dy >= 0)
+	{
+		for (int y = keptFirst; y < keptLast; y++) moveRow(y);
+	}
+	else
+	{
+		for (int y = keptLast - 1; y >= keptFirst; y--) moveRow(y);
+	}
+
+	const auto markMissing = [&](int x, int y, int w, int h)
+	{
+		for (int row = y; row < y + h; row++)
+		{
+			std::fill_n(&_states[row * width + x], w, PixelState::Missing);
+		}
+	};
+	if (dy > 0) markMissing(0, keptLast, width, height - keptLast);
+	else if (dy < 0) markMissing(0, 0, width, keptFirst);
+	if (dx > 0) markMissing(keptWidth, keptFirst, dx, keptLast - keptFirst);
+	else if (dx < 0) markMissing(0, keptFirst, -dx, keptLast - keptFirst);
+
+	// Track the grid the kept pixels were computed on so rounding never accumulates
+	_bufferBox = Se::SimBox(old.TopLeft + Position(dx * xScale, dy * yScale),
+	                        old.BottomRight + Position(dx * xScale, dy * yScale));
+	return true;
+}
+
+auto CpuHost::ReprojectBuffer(const struct SimBox& simBox) -> bool
+{
+	const auto& old = *_bufferBox;
+	const int width = SimWidth();
+	const int height = SimHeight();
+	const double oldXScale = (old.BottomRight.x - old.TopLeft.x) / static_cast<double>(width);
+	const double oldYScale = (old.BottomRight.y - old.TopLeft.y) / static_cast<double>(height);
+	const double xScale = (simBox.BottomRight.x - simBox.TopLeft.x) / static_cast<double>(width);
+	const double yScale = (simBox.BottomRight.y - simBox.TopLeft.y) / static_cast<double>(height);
+
+	// Nearest old sample of every column and row, -1 when outside the old view. The mapping
+	// is separable, so a pixel is exact when both its column and its row land on a sample.
+	const auto mapAxis = [](int count, double origin, double scale, double oldOrigin, double oldScale,
+	                        std::vector<int>& source, std::vector<bool>& exact)
+	{
+		source.resize(count);
+		exact.resize(count);
+		for (int i = 0; i < count; i++)
+		{
+			const double oldIndex = (origin + i * scale - oldOrigin) / oldScale;
+			const int nearest = static_cast<int>(std::round(oldIndex));
+			source[i] = nearest >= 0 && nearest < count ? nearest : -1;
+			exact[i] = std::abs(oldIndex - nearest) <= PixelTolerance;
+		}
+	};
+
+	std::vector<int> sourceX, sourceY;
+	std::vector<bool> exactX, exactY;
+	mapAxis(width, simBox.TopLeft.x, xScale, old.TopLeft.x, oldXScale, sourceX, exactX);
+	mapAxis(height, simBox.TopLeft.y, yScale, old.TopLeft.y, oldYScale, sourceY, exactY);
+
+	bool overlaps = false;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			const int i = y * width + x;
+			if (sourceX[x] < 0 || sourceY[y] < 0)
+			{
+				_previewArray[i] = 0;
+				_previewStates[i] = PixelState::Missing;
+				continue;
+			}
+
+			const int source = sourceY[y] * width + sourceX[x];
+			const bool exact = exactX[x] && exactY[y] && _states[source] == PixelState::Fresh;
+			_previewArray[i] = _fractalArray[source];
+			_previewStates[i] = exact ? PixelState::Fresh : std::max(PixelState::Preview, _states[source]);
+			overlaps = true;
+		}
+	}
+
+	if (!overlaps)
+	{
+		return false;
+	}
+
+	std::swap(_fractalArray, _previewArray);
+	std::swap(_states, _previewStates);
+	_bufferBox = simBox;
+	return true;
+}
+
+void CpuHost::QueueStaleTiles()
+{
+	const int width = SimWidth();
+	const int height = SimHeight();
+	const auto focus = FocusPoint();
+	const Position center(focus.X, focus.Y);
+
+	struct QueuedTile
+	{
+		Tile Tile;
+		bool Missing;
+		int ErrorClass;
+		double Distance;
+	};
+	std::vector<QueuedTile> queued;
+
+	for (int y = 0; y < height; y += _tileSize)
+	{
+		for (int x = 0; x < width; x += _tileSize)
+		{
+			const Tile tile{x, y, std::min(_tileSize, width - x), std::min(_tileSize, height - y)};
+
+			bool stale = false, missing = false;
+			int low = std::numeric_limits<int>::max(), high = std::numeric_limits<int>::min();
+			for (int row = tile.Y; row < tile.Y + tile.Height; row++)
+			{
+				for (int col = tile.X; col < tile.X + tile.Width; col++)
+				{
+					const int i = row * width + col;
+					stale |= _states[i] != PixelState::Fresh;
+					missing |= _states[i] == PixelState::Missing;
+					low = std::min(low, _fractalArray[i]);
+					high = std::max(high, _fractalArray[i]);
+				}
+			}
+			if (!stale)
+			{
+				continue;
+			}
+
+			// A flat preview is most likely right, keep it unless the spread is too large
+			const int spread = high - low;
+			if (!missing && _reprojectionTolerance >= 0 && spread <= _reprojectionTolerance)
+			{
+				for (int row = tile.Y; row < tile.Y + tile.Height; row++)
+				{
+					std::fill_n(&_states[row * width + tile.X], tile.Width, PixelState::Fresh);
+				}
+				continue;
+			}
+
+			const Position tileCenter(tile.X + tile.Width / 2.0, tile.Y + tile.Height / 2.0);
+			queued.push_back({
+				tile, missing, static_cast<int>(std::bit_width(static_cast<unsigned>(spread))),
+				VecUtils::LengthSq(tileCenter - center)
+			});
+		}
+	}
+
+	// Holes first, then the worst previews, then outwards from the focus
+	std::sort(queued.begin(), queued.end(), [](const QueuedTile& a, const QueuedTile& b)
+	{
+		if (a.Missing != b.Missing) return a.Missing;
+		if (a.ErrorClass != b.ErrorClass) return a.ErrorClass > b.ErrorClass;
+		return a.Distance < b.Distance;
+	});
+
+	for (const auto& entry : queued)
+	{
+		_pendingTiles.push_back(entry.Tile);
+	}
+}
+
+auto CpuHost::ValidateFrame(const struct SimBox& simBox, const std::vector<Tile>& tiles, int tileSize) -> size_t
+{
+	// Brute force the same tiles into a scratch buffer with the same workers. The frame's stats
+	// are about the subdivided pass, the check leaves them alone.
+	std::vector<WorkerStats> stats;
+	PrepareWorkers(simBox);
+	for (auto& worker : _workers)
+	{
+		stats.push_back(worker->Stats);
+		worker->FractalArray = _previewArray.data();
+		worker->Finished = nullptr;
+		worker->Step = 1;
+		worker->Refine = false;
+		worker->States = nullptr;
+		worker->Subdivide = false;
+	}
+	Dispatch(tiles, tileSize);
+	if (!Cancelled())
+	{
+		FinishTiles(_previewArray.data(), tiles);
+	}
+	for (size_t i = 0; i < _workers.size(); i++)
+	{
+		_workers[i]->Stats = stats[i];
+	}
+
+	size_t mismatches = 0;
+	for (const auto& tile : tiles)
+	{
+		for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+		{
+			const int* subdivided = &_fractalArray[y * SimWidth() + tile.X];
+			const int* bruteForce = &_previewArray[y * SimWidth() + tile.X];
+			for (int x = 0; x < tile.Width; x++)
+			{
+				mismatches += subdivided[x] != bruteForce[x];
+			}
+		}
+	}
+	return mismatches;
+}
+
+auto CpuHost::CacheGridFor(const struct SimBox& simBox, ulong iterations) const -> std::optional<CacheGrid>
+{
+	if (!_cacheKey || simBox.Spacing.Mantissa == 0.0)
+	{
+		return std::nullopt;
+	}
+
+	CacheGrid grid;
+	uint64_t parameters = *_cacheKey;
+	const bool deep = _precision == Kernels::Precision::DoubleDouble ||
+		_precision == Kernels::Precision::Perturbation;
+	if (deep)
+	{
+		// Double cannot place deep pixels on a shared grid, only the very same view finds its tiles
+		for (const uint64_t value : {
+			     simBox.CenterX.Hash(), simBox.CenterY.Hash(),
+			     static_cast<uint64_t>(SimWidth()), static_cast<uint64_t>(SimHeight())
+		     })
+		{
+			parameters = TileCache::Combine(parameters, value);
+		}
+	}
+	else
+	{
+		const double spacing = simBox.Spacing.ToDouble();
+		const double x = simBox.TopLeft.x / spacing;
+		const double y = simBox.TopLeft.y / spacing;
+		if (!(std::abs(x) < MaxCacheOrigin && std::abs(y) < MaxCacheOrigin))
+		{
+			return std::nullopt;
+		}
+
+		// Views a whole number of pixels apart share a grid, the phase tells the others apart
+		const auto steps = static_cast<int64_t>(std::round(1.0 / PixelTolerance));
+		const auto place = [steps](double position, int64_t& origin)
+		{
+			origin = static_cast<int64_t>(std::floor(position));
+			int64_t phase = std::llround((position - static_cast<double>(origin)) * static_cast<double>(steps));
+			if (phase == steps)
+			{
+				origin++;
+				phase = 0;
+			}
+			return phase;
+		};
+		parameters = TileCache::Combine(parameters, static_cast<uint64_t>(place(x, grid.X)));
+		parameters = TileCache::Combine(parameters, static_cast<uint64_t>(place(y, grid.Y)));
+	}
+
+	for (const uint64_t value : {
+		     static_cast<uint64_t>(iterations), static_cast<uint64_t>(_precision),
+		     static_cast<uint64_t>(_precisionMode), static_cast<uint64_t>(_subdivision && _supportsSubdivision),
+		     static_cast<uint64_t>(_periodicity), std::bit_cast<uint64_t>(_periodicityTolerance),
+		     std::bit_cast<uint64_t>(simBox.Spacing.Mantissa), static_cast<uint64_t>(simBox.Spacing.Exponent),
+		     CacheParameters()
+	     })
+	{
+		parameters = TileCache::Combine(parameters, value);
+	}
+	grid.Parameters = parameters;
+	return grid;
+}
+
+auto CpuHost::LoadCachedTiles(const CacheGrid& grid) -> size_t
+{
+	constexpr int64_t size = TileCache::TileSize;
+	const int width = SimWidth();
+	const int height = SimHeight();
+	const auto tileOf = [](int64_t pixel)
+	{
+		return pixel >= 0 ? pixel / size : -((-pixel + size - 1) / size);
+	};
+
+	auto& cache = TileCache::Instance();
+	std::vector<int> pixels;
+	size_t loaded = 0;
+	for (int64_t ty = tileOf(grid.Y); ty <= tileOf(grid.Y + height - 1); ty++)
+	{
+		for (int64_t tx = tileOf(grid.X); tx <= tileOf(grid.X + width - 1); tx++)
+		{
+			if (!cache.Find({grid.Parameters, tx, ty}, pixels))
+			{
+				continue;
+			}
+
+			// The part of the tile in view, in view pixels
+			const int x0 = static_cast<int>(std::max<int64_t>(tx * size - grid.X, 0));
+			const int y0 = static_cast<int>(std::max<int64_t>(ty * size - grid.Y, 0));
+			const int x1 = static_cast<int>(std::min<int64_t>((tx + 1) * size - grid.X, width));
+			const int y1 = static_cast<int>(std::min<int64_t>((ty + 1) * size - grid.Y, height));
+			for (int y = y0; y < y1; y++)
+			{
+				const int* row = &pixels[(grid.Y + y - ty * size) * size + (grid.X - tx * size)];
+				for (int x = x0; x < x1; x++)
+				{
+					const int i = y * width + x;
+					if (row[x] != TileCache::Hole && _states[i] != PixelState::Fresh)
+					{
+						_fractalArray[i] = row[x];
+						_states[i] = PixelState::Fresh;
+						loaded++;
+					}
+				}
+			}
+		}
+	}
+	return loaded;
+}
+
+void CpuHost::StoreCachedTiles(const CacheGrid& grid)
+{
+	constexpr int64_t size = TileCache::TileSize;
+	const int width = SimWidth();
+	const int height = SimHeight();
+	const auto tileOf = [](int64_t pixel)
+	{
+		return pixel >= 0 ? pixel / size : -((-pixel + size - 1) / size);
+	};
+
+	auto& cache = TileCache::Instance();
+	std::vector<int> pixels(size * size);
+	for (int64_t ty = tileOf(grid.Y); ty <= tileOf(grid.Y + height - 1); ty++)
+	{
+		for (int64_t tx = tileOf(grid.X); tx <= tileOf(grid.X + width - 1); tx++)
+		{
+			// Tiles on the edge of the view keep holes where it ends
+			std::fill(pixels.begin(), pixels.end(), TileCache::Hole);
+			const int x0 = static_cast<int>(std::max<int64_t>(tx * size - grid.X, 0));
+			const int y0 = static_cast<int>(std::max<int64_t>(ty * size - grid.Y, 0));
+			const int x1 = static_cast<int>(std::min<int64_t>((tx + 1) * size - grid.X, width));
+			const int y1 = static_cast<int>(std::min<int64_t>((ty + 1) * size - grid.Y, height));
+			for (int y = y0; y < y1; y++)
+			{
+				int* row = &pixels[(grid.Y + y - ty * size) * size + (grid.X - tx * size)];
+				std::copy(&_fractalArray[y * width + x0], &_fractalArray[y * width + x1], row + x0);
+			}
+			cache.Store({grid.Parameters, tx, ty}, pixels);
+		}
+	}
+}
+
+auto CpuHost::FocusPoint() const -> TileFocus
+{
+	if (const auto& focus = Focus())
+	{
+		return {focus->x, focus->y};
+	}
+	return {SimWidth() / 2.0f, SimHeight() / 2.0f};
+}
+
+auto CpuHost::TileHasMissing(const Tile& tile) const -> bool
+{
+	for (int row = tile.Y; row < tile.Y + tile.Height; row++)
+	{
+		const auto* first = &_states[row * SimWidth() + tile.X];
+		if (std::find(first, first + tile.Width, PixelState::Missing) != first + tile.Width)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+auto CpuHost::ChoosePrecision(const struct SimBox& simBox, size_t iterations) const -> Kernels::Precision
+{
+	switch (_precisionMode)
+	{
+	case PrecisionMode::Float: return Kernels::Precision::Float;
+	case PrecisionMode::Double: return Kernels::Precision::Double;
+	case PrecisionMode::DoubleDouble: return Kernels::Precision::DoubleDouble;
+	default: break;
+	}
+
+	const auto& tl = simBox.TopLeft;
+	const auto& br = simBox.BottomRight;
+	const auto size = simBox.PreciseBottomRight - simBox.PreciseTopLeft;
+	const double spacing = std::min(std::abs(size.x.ToDouble()) / SimWidth(), std::abs(size.y.ToDouble()) / SimHeight());
+
+	// Orbits reach the escape radius, so the kernels have to resolve pixels out there as well.
+	// Tiles past OutsideRadius take float whatever this picks.
+	const double corner = std::max({std::abs(tl.x), std::abs(tl.y), std::abs(br.x), std::abs(br.y)});
+	return PrecisionFor(std::clamp(corner, 2.0, OutsideRadius), spacing, iterations, _precision);
+}
+
+auto CpuHost::PrecisionFor(double extent, double spacing, size_t iterations,
+                           Kernels::Precision current) -> Kernels::Precision
+{
+	const double doubleStep = extent * std::numeric_limits<double>::epsilon();
+	const bool deep = current == Kernels::Precision::DoubleDouble || current == Kernels::Precision::Perturbation;
+	const double doubleGuard = deep ? DoubleGuardBand * 2.0 : DoubleGuardBand;
+	if (spacing < doubleGuard * doubleStep)
+	{
+		return Kernels::Precision::DoubleDouble;
+	}
+
+	if (iterations >= MaxFloatIterations)
+	{
+		return Kernels::Precision::Double;
+	}
+
+	const double floatStep = extent * std::numeric_limits<float>::epsilon();
+	const double guard = current == Kernels::Precision::Float ? FloatGuardBand / 2.0 : FloatGuardBand;
+	return spacing >= guard * floatStep ? Kernels::Precision::Float : Kernels::Precision::Double;
 }
 }
@@ -1,55 +1,392 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+
 #include "Common.h"
 #include "Host.h"
+#include "ComputeHosts/TileCache.h"
+#include "ComputeHosts/TileScheduler.h"
+#include "Kernels/Kernels.h"
 
 namespace Se
 {
+struct WorkerStats
+{
+	size_t Tiles = 0;
+	size_t StolenTiles = 0;
+	size_t FilledPixels = 0;
+	size_t SavedIterations = 0;
+	size_t SkippedPixels = 0;
+	// Iterations that did work, and vector steps times the lanes they had
+	size_t LaneIterations = 0;
+	size_t VectorIterations = 0;
+	size_t GlitchedPixels = 0;
+	size_t ApproximatedIterations = 0;
+	size_t ExtendedIterations = 0;
+	// Tiles computed in each precision
+	std::array<size_t, static_cast<size_t>(Kernels::Precision::Count)> PrecisionTiles{};
+	double BusySeconds = 0.0;
+};
+
+// What a pixel of a reused buffer holds, the host recomputes everything but Fresh
+enum class PixelState : uint8_t
+{
+	Fresh,
+	Preview,
+	Missing
+};
+
+// Which kernels the workers iterate with. Automatic uses float while a pixel stays well above
+// float's resolution and double-double once it gets close to double's, see
+// CpuHost::FloatGuardBand and CpuHost::DoubleGuardBand.
+enum class PrecisionMode
+{
+	Automatic,
+	Float,
+	Double,
+	DoubleDouble
+};
+
+// Count pixels of row Y, starting at column X and advancing Stride columns each
+struct Run
+{
+	int X, Y, Count, Stride;
+};
+
 struct Worker
 {
 	virtual ~Worker() = default;
-	virtual void Compute() = 0;
+	void Compute(TileScheduler& scheduler);
+	void ComputeTile(const Tile& tile);
+
+	// Computes count pixels of row y, starting at column x and advancing stride columns each
+	virtual void ComputeSpan(int x, int y, int count, int stride) = 0;
+	// Computes a batch of runs, workers that can refill SIMD lanes across runs override this
+	virtual void ComputeRuns(const std::vector<Run>& runs);
+
+	// Whether a rectangle with a uniform border is known to be uniform inside
+	virtual auto SupportsSubdivision() const -> bool { return false; }
 
-	std::atomic<size_t>* WorkerComplete = nullptr;
+	size_t Index = 0;
+	WorkerStats Stats;
 
 	int* FractalArray;
 	int SimWidth = 0;
 
-	Position ImageTL = {0.0, 0.0};
-	Position ImageBR = {0.0, 0.0};
 	Position FractalTL = {0.0, 0.0};
-	Position FractalBR = {0.0, 0.0};
+	// What FractalTL lost of the view's corner, for the double-double kernels
+	Position FractalTLLow = {0.0, 0.0};
+	double XScale = 0.0;
+	double YScale = 0.0;
+	// FractalTL, XScale and YScale are in units of 2^Exponent, for kernels that support it
+	int64_t Exponent = 0;
 
 	size_t Iterations = 0;
-	bool Alive = true;
 
-	std::thread Thread;
-	std::condition_variable CvStart;
-	std::mutex Mutex;
+	// Progressive passes only compute every Step:th pixel. A refining pass skips the
+	// pixels the previous, twice as coarse, pass already computed.
+	int Step = 1;
+	bool Refine = false;
+
+	// When set, only pixels that are not Fresh are computed, and marked Fresh afterwards
+	PixelState* States = nullptr;
+
+	// Called on the worker's thread with every tile it is done with
+	std::function<void(const Tile&)> Finished;
+
+	// Mariani-Silver: iterate rectangle borders only, fill uniform ones and split the rest
+	bool Subdivide = false;
+
+	// Retire orbits that cycle back within the tolerance as interior points
+	bool CheckPeriodicity = false;
+	double PeriodicityTolerance = 1e-10;
+
+	// Collect a tile's runs and hand them over in one batch instead of span by span
+	bool Streaming = false;
+
+	// The precision of the frame. With AutomaticPrecision set, each tile takes what its own
+	// coordinates need, which is never more than the frame, see ChooseTilePrecision.
+	Kernels::Precision Precision = Kernels::Precision::Double;
+	bool AutomaticPrecision = false;
+
+protected:
+	// The active instruction set's kernels in the precision of the current tile
+	auto Functions() const -> const Kernels::KernelFunctions&;
+	auto TilePrecision() const -> Kernels::Precision;
+	auto MakeSpan(int x, int y, int count, int stride) const -> Kernels::Span;
+	// Reuses one buffer, valid until the next call
+	auto MakeSpans(const std::vector<Run>& runs) -> const std::vector<Kernels::Span>&;
+	void AddStats(const Kernels::SpanStats& stats);
+
+private:
+	// Inclusive bounds, neighbouring rectangles share their border
+	struct Rect
+	{
+		int X0, Y0, X1, Y1;
+	};
+
+	auto ChooseTilePrecision(const Tile& tile) const -> Kernels::Precision;
+	void ComputeStale(const Tile& tile);
+	void ComputeSubdivided(const Tile& tile);
+	// Fills r if its border is uniform, else queues its split lines and pushes its quarters
+	void SubdivideRect(const Rect& r, std::vector<Rect>& next);
+	void FillBlocks(const Tile& tile);
+	void QueueRun(int x, int y, int count, int stride);
+	void FlushRuns();
+
+	std::vector<Run> _runs;
+	std::vector<Kernels::Span> _spans;
+	Kernels::Precision _tilePrecision = Kernels::Precision::Double;
 };
 
+using WorkerFactory = std::function<std::unique_ptr<Worker>()>;
+
 class CpuHost : public Host
 {
 public:
-	CpuHost(int simWidth, int simHeight);
+	// Pixel spacing of each progressive pass, coarsest first. Tiles are aligned to the first.
+	static constexpr std::array<int, 4> ProgressiveSteps = {8, 4, 2, 1};
+	// How far off a whole pixel a reused sample may be and still count as exact
+	static constexpr double PixelTolerance = 1e-3;
+	// Preview tiles refined per frame and worker after a zoom
+	static constexpr size_t ReprojectionTilesPerWorker = 4;
+	// Rectangles this small are iterated pixel by pixel instead of split further
+	static constexpr int MinSubdivisionSize = 6;
+	// Automatic precision only uses float while a pixel spans this many float steps at the largest
+	// coordinate in view, and goes back to double below half of it. The margin absorbs rounding that
+	// builds up over the orbit, the hysteresis keeps the precision from flipping between frames.
+	static constexpr double FloatGuardBand = 1024.0;
+	// The same for double, below it the double-double kernels take over
+	static constexpr double DoubleGuardBand = 1024.0;
+	// Past twice the escape radius every pixel escapes within an iteration whatever the precision,
+	// so such tiles always take float and the coordinates in view only matter up to here
+	static constexpr double OutsideRadius = 4.0;
+	// Float counts iterations exactly up to 2^24
+	static constexpr size_t MaxFloatIterations = size_t(1) << 24;
+
+	// The guard band rule for pixels spacing apart with coordinates up to extent. current is
+	// the precision in use, which the hysteresis holds on to.
+	static auto PrecisionFor(double extent, double spacing, size_t iterations,
+	                         Kernels::Precision current) -> Kernels::Precision;
+	// Views further out than this many pixels from the origin place their pixels on the cache
+	// grid too coarsely to use it
+	static constexpr double MaxCacheOrigin = 1099511627776.0;
+
+
+	CpuHost(int simWidth, int simHeight, WorkerFactory workerFactory);
 	~CpuHost() override;
 
 	void OnRender(Scene& scene) override;
+	// Finished tiles stay in the image, the ones that never ran are computed again
+	void CancelComputation() override;
+	// Whether workers are computing a frame in the background
+	auto Computing() const -> bool;
 
-	void AddWorker(std::unique_ptr<Worker> worker);
+	// Only safe to change while no frame is computing, see CancelComputation
 	auto Workers() -> std::vector<std::unique_ptr<Worker>>&;
 	auto Workers() const -> const std::vector<std::unique_ptr<Worker>>&;
+	// What each worker did in the last finished frame, the counters below sum these up
+	auto FrameStats() const -> const std::vector<WorkerStats>&;
+
+	auto TileSize() const -> int;
+	void SetTileSize(int tileSize);
+
+	auto Progressive() const -> bool;
+	void SetProgressive(bool progressive);
+	auto ProgressivePass() const -> int;
+
+	// Forces the next computation to redo the whole image, for changes the SimBox does not show
+	void Invalidate();
+	auto Panned() const -> bool;
+	auto Reprojected() const -> bool;
+	auto PendingTiles() const -> size_t;
+
+	// What the workers compute besides the view and the settings of this host, such as the
+	// fractal and its constants. Hosts without a key stay out of the tile cache.
+	auto CacheKey() const -> const std::optional<uint64_t>&;
+	void SetCacheKey(std::optional<uint64_t> key);
+	// Pixels of the current view that came out of the tile cache
+	auto CachedPixels() const -> size_t;
+
+	// Largest iteration spread a preview tile may have and still be kept, negative recomputes all
+	auto ReprojectionTolerance() const -> int;
+	void SetReprojectionTolerance(int tolerance);
+
+	auto SupportsSubdivision() const -> bool;
+	auto Subdivision() const -> bool;
+	void SetSubdivision(bool subdivision);
+	// Recomputes subdivided frames by brute force and counts the pixels that differ
+	auto ValidateSubdivision() const -> bool;
+	void SetValidateSubdivision(bool validate);
+	auto SubdivisionMismatches() const -> size_t;
+	auto FilledPixels() const -> size_t;
+
+	auto Periodicity() const -> bool;
+	void SetPeriodicity(bool periodicity);
+	auto PeriodicityTolerance() const -> double;
+	void SetPeriodicityTolerance(double tolerance);
+	auto SavedIterations() const -> size_t;
+	// Pixels a worker knew the answer to without iterating
+	auto SkippedPixels() const -> size_t;
+
+	// Refill SIMD lanes as soon as a pixel finishes instead of waiting for the slowest lane
+	auto Streaming() const -> bool;
+	void SetStreaming(bool streaming);
+	// Share of the SIMD lanes that did useful work last frame
+	auto LaneUtilisation() const -> double;
+
+	struct LaneBenchmark
+	{
+		double GroupedSeconds = 0.0;
+		double GroupedUtilisation = 0.0;
+		double StreamingSeconds = 0.0;
+		double StreamingUtilisation = 0.0;
+	};
+	// Computes the current view once without and once with streaming, the image is left alone
+	void RunLaneBenchmark();
+	auto LastLaneBenchmark() const -> const std::optional<LaneBenchmark>&;
+
+	auto Precision() const -> PrecisionMode;
+	void SetPrecision(PrecisionMode mode);
+	// The precision the current image is computed in, and how many tiles each precision took
+	auto ActivePrecision() const -> Kernels::Precision;
+	auto PrecisionTiles(Kernels::Precision precision) const -> size_t;
+
+	auto TileCount() const -> size_t;
+	// Tiles the last frame got through within the budget, and the ones it left for the next
+	auto FinishedTiles() const -> size_t;
+	auto CarriedTiles() const -> size_t;
+	auto FrameSeconds() const -> double;
+	auto Utilisation(size_t workerIndex) const -> double;
+
+protected:
+	CpuHost(HostType type, std::string name, int simWidth, int simHeight, WorkerFactory workerFactory);
+
+	// Resets every worker for a pass over simBox, PrepareWorkers adjusts them further
+	void SetupWorkers(int* fractalArray, const struct SimBox& simBox);
+	// Tiles nearest the focus go first. With a budget in milliseconds, workers stop taking
+	// tiles once it is spent and the ones left stay queued in the scheduler.
+	auto Dispatch(const std::vector<Tile>& regions, int tileSize, double budget = 0.0) -> double;
+	// Set while the running frame is being cancelled, for long steps of the hooks below
+	auto Cancelled() const -> bool;
+
+	// Picks the precision of a frame, tiles may still drop to a cheaper one
+	virtual auto ChoosePrecision(const struct SimBox& simBox, size_t iterations) const -> Kernels::Precision;
+	// The hooks run in the background with the frame, ahead of and after its tiles
+	virtual void PrepareWorkers(const struct SimBox& simBox) {}
+	// Called once the tiles of a frame are in fractalArray, with the workers still set up for them
+	virtual void FinishTiles(int* fractalArray, const std::vector<Tile>& tiles) {}
+	// Settings of a derived host that change its pixels, for the tile cache
+	virtual auto CacheParameters() const -> uint64_t { return 0; }
 
 private:
+	// Where a view's pixels lie on the tile cache's grid
+	struct CacheGrid
+	{
+		uint64_t Parameters = 0;
+		int64_t X = 0, Y = 0;
+	};
+
+	struct FrameResult
+	{
+		double Seconds = 0.0;
+		// Tiles the budget did not reach
+		std::vector<Tile> Remaining;
+		// Pixels subdivision got wrong, when the finished frame was checked against brute force
+		std::optional<size_t> Mismatches;
+	};
+
 	void ComputeImage() override;
 	void RenderImage() override;
 	void Resize(int width, int height) override;
 
+	// Takes over the result of a frame that finished in the background
+	void FinishFrame();
+	// Hands a finished tile of the frame over to RenderImage
+	void PresentTile(const Tile& tile);
+	void SyncWorkers(size_t count);
+	auto ShiftBuffer(const struct SimBox& simBox) -> bool;
+	auto ReprojectBuffer(const struct SimBox& simBox) -> bool;
+	void QueueStaleTiles();
+	// Runs inside the frame, once the subdivided pass over the tiles is done
+	auto ValidateFrame(const struct SimBox& simBox, const std::vector<Tile>& tiles, int tileSize) -> size_t;
+	// Empty for views the cache cannot place and for hosts without a key. Deep views are keyed by
+	// their exact centre and size instead of a shared grid.
+	auto CacheGridFor(const struct SimBox& simBox, ulong iterations) const -> std::optional<CacheGrid>;
+	// Fills the pixels that are not Fresh from the cache, returns how many it had
+	auto LoadCachedTiles(const CacheGrid& grid) -> size_t;
+	void StoreCachedTiles(const CacheGrid& grid);
+	auto TileHasMissing(const Tile& tile) const -> bool;
+	// Focus() in pixels, or the centre of the image
+	auto FocusPoint() const -> TileFocus;
+
 private:
+	WorkerFactory _workerFactory;
 	std::vector<std::unique_ptr<Worker>> _workers;
-	std::atomic<size_t> _nWorkerComplete = 0;
+
+	TileScheduler _scheduler;
+	int _tileSize = 32;
+	double _frameSeconds = 0.0;
+
+	bool _progressive = false;
+	int _progressivePass = 0;
+
+	// The view the buffer holds results or previews for, if any, and which pixels are exact
+	std::optional<struct SimBox> _bufferBox;
+	ulong _bufferIterations = 0;
+	std::vector<PixelState> _states;
+	std::deque<Tile> _pendingTiles;
+	// Whether every Fresh pixel is exact, kept previews are not
+	bool _bufferExact = false;
+	int _reprojectionTolerance = 0;
+	bool _panned = false;
+	bool _reprojected = false;
+
+	bool _supportsSubdivision = false;
+	bool _subdivision = false;
+	bool _validateSubdivision = false;
+	size_t _subdivisionMismatches = 0;
+
+	bool _periodicity = false;
+	double _periodicityTolerance = 1e-10;
+
+	bool _streaming = true;
+
+	PrecisionMode _precisionMode = PrecisionMode::Automatic;
+	Kernels::Precision _precision = Kernels::Precision::Double;
+	std::optional<LaneBenchmark> _laneBenchmark;
+
+	std::optional<uint64_t> _cacheKey;
+	size_t _cachedPixels = 0;
+
+	// Tiles of a whole image frame that did not fit the budget, sent out before the next pass
+	std::vector<Tile> _carryTiles;
+
+	// The frame computing in the background and how it was set up
+	std::future<FrameResult> _frame;
+	std::atomic<bool> _cancelled = false;
+	std::optional<struct SimBox> _frameBox;
+	ulong _frameIterations = 0;
+	std::vector<Tile> _frameTiles;
+	int _frameStep = 1;
+	TileFocus _frameFocus;
+	std::optional<CacheGrid> _frameGrid;
+	bool _frameReusing = false;
+	std::vector<WorkerStats> _frameStats;
+
+	// What RenderImage shows while a frame is running, the workers never write it. Finished
+	// tiles reach it through _finishedTiles.
+	std::vector<int> _presented;
+	std::mutex _presentMutex;
+	std::vector<std::pair<Tile, std::vector<int>>> _finishedTiles;
 
 	sf::VertexArray _vertexArray;
-	int* _fractalArray;
+	std::vector<int> _fractalArray;
+	std::vector<int> _previewArray;
+	std::vector<PixelState> _previewStates;
 };
 }
@@ -0,0 +1,349 @@
+﻿#include "ComputeHosts/PerturbationHost.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Se
+{
+void PerturbationHost::PerturbationWorker::ComputeSpan(int x, int y, int count, int stride)
+{
+	Kernels::SpanStats stats;
+	if (TilePrecision() != Kernels::Precision::Perturbation)
+	{
+		Functions().Mandelbrot(MakeSpan(x, y, count, stride), stats);
+		AddStats(stats);
+		return;
+	}
+
+	auto span = MakeSpan(x, y, count, stride);
+	span.X0 = OffsetTL.x + x * OffsetXScale;
+	span.XStep = OffsetXScale * stride;
+	span.Y = OffsetTL.y + y * OffsetYScale;
+	span.X0Low = 0.0;
+	span.YLow = 0.0;
+	span.Exponent = OffsetExponent;
+	Kernels::Active().Perturbation(span, Orbit, stats);
+	AddStats(stats);
+}
+
+void PerturbationHost::PerturbationWorker::ComputeRuns(const std::vector<Run>& runs)
+{
+	if (TilePrecision() == Kernels::Precision::Perturbation)
+	{
+		Worker::ComputeRuns(runs);
+		return;
+	}
+
+	Kernels::SpanStats stats;
+	const auto& spans = MakeSpans(runs);
+	Functions().MandelbrotStream(spans.data(), spans.size(), stats);
+	AddStats(stats);
+}
+
+PerturbationHost::PerturbationHost(int simWidth, int simHeight) :
+	CpuHost(HostType::CpuPerturbation, "CPU Perturbation", simWidth, simHeight, []
+	{
+		return std::make_unique<PerturbationWorker>();
+	})
+{
+}
+
+PerturbationHost::~PerturbationHost()
+{
+	// The frame may still be using the orbits
+	CancelComputation();
+}
+
+auto PerturbationHost::OrbitLength() const -> size_t
+{
+	return _orbitLength;
+}
+
+auto PerturbationHost::OrbitBits() const -> int
+{
+	return _orbitBits;
+}
+
+auto PerturbationHost::OrbitSeconds() const -> double
+{
+	return _orbitSeconds;
+}
+
+auto PerturbationHost::ReferenceCount() const -> int
+{
+	return _referenceCount;
+}
+
+auto PerturbationHost::GlitchedPixels() const -> size_t
+{
+	return _glitchedPixels;
+}
+
+auto PerturbationHost::UnresolvedPixels() const -> size_t
+{
+	return _unresolvedPixels;
+}
+
+auto PerturbationHost::GlitchTiles() const -> size_t
+{
+	return _glitchTiles;
+}
+
+auto PerturbationHost::Approximation() const -> bool
+{
+	return _approximation;
+}
+
+void PerturbationHost::SetApproximation(bool approximation)
+{
+	CancelComputation();
+	_approximation = approximation;
+	_referenceBla.Clear();
+	_blaOffset = 0.0;
+}
+
+auto PerturbationHost::CacheParameters() const -> uint64_t
+{
+	return _approximation;
+}
+
+auto PerturbationHost::ApproximatedIterations() const -> size_t
+{
+	size_t approximated = 0;
+	for (const auto& stats : FrameStats())
+	{
+		approximated += stats.ApproximatedIterations;
+	}
+	return approximated;
+}
+
+auto PerturbationHost::ExtendedIterations() const -> size_t
+{
+	size_t extended = 0;
+	for (const auto& stats : FrameStats())
+	{
+		extended += stats.ExtendedIterations;
+	}
+	return extended;
+}
+
+auto PerturbationHost::ChoosePrecision(const struct SimBox& simBox, size_t iterations) const -> Kernels::Precision
+{
+	// Offsets from a reference cost about what double does, far less than double-double
+	const auto precision = CpuHost::ChoosePrecision(simBox, iterations);
+	return precision == Kernels::Precision::DoubleDouble ? Kernels::Precision::Perturbation : precision;
+}
+
+void PerturbationHost::PrepareWorkers(const struct SimBox& simBox)
+{
+	_orbitSeconds = 0.0;
+	if (ActivePrecision() != Kernels::Precision::Perturbation)
+	{
+		return;
+	}
+
+	// Deep enough and the kernels keep the offsets scaled until they grow back into range
+	const ExtendedReal& spacing = simBox.Spacing;
+	_exponent = spacing.Exponent < Kernels::MinPlainExponent ? spacing.Exponent : 0;
+	_xScale = spacing.Scaled(_exponent);
+	_yScale = spacing.Scaled(_exponent);
+
+	// spacing >= 2^(Exponent - 1)
+	const int64_t spacingBits = spacing.Mantissa != 0.0 ? std::max<int64_t>(0, 1 - spacing.Exponent) : 0;
+	const int limbs = BigReal::LimbsFor(static_cast<int>(spacingBits) + GuardBits);
+	_orbitBits = limbs * BigReal::LimbBits;
+
+	// The reference sits on the pixel nearest the centre
+	const double refX = SimWidth() / 2, refY = SimHeight() / 2;
+	const BigReal cr = simBox.CenterX.Resized(limbs) +
+		BigReal(ExtendedReal((refX - SimWidth() / 2.0) * _xScale, _exponent), limbs);
+	const BigReal ci = simBox.CenterY.Resized(limbs) +
+		BigReal(ExtendedReal((refY - SimHeight() / 2.0) * _yScale, _exponent), limbs);
+
+	// Only zooming around an unchanged centre, at the same precision and iterations, keeps the
+	// orbit. Panning moves the reference and computes it again.
+	if (cr != _reference.Cr() || ci != _reference.Ci() || limbs != _reference.Cr().FractionLimbs() ||
+		ComputeIterations() != _reference.Iterations())
+	{
+		_reference.Compute(cr, ci, ComputeIterations(), [this] { return Cancelled(); });
+		_orbitSeconds = _reference.Seconds();
+		_orbitLength = _reference.Length();
+		_blaOffset = 0.0;
+		if (Cancelled())
+		{
+			return;
+		}
+	}
+
+	// Any pixel may end up with a reference anywhere in the view
+	const double maxOffset = ExtendedReal(std::hypot(SimWidth() * _xScale, SimHeight() * _yScale), _exponent).ToDouble();
+	if (_approximation && maxOffset != _blaOffset)
+	{
+		_referenceBla.Build(_reference, maxOffset);
+		_orbitSeconds += _referenceBla.Seconds();
+		_blaOffset = maxOffset;
+	}
+	UseReference(_reference, _referenceBla, refX, refY);
+}
+
+void PerturbationHost::FinishTiles(int* fractalArray, const std::vector<Tile>& tiles)
+{
+	if (ActivePrecision() != Kernels::Precision::Perturbation)
+	{
+		_referenceCount = 0;
+		_glitchedPixels = 0;
+		_unresolvedPixels = 0;
+		_glitchTiles = 0;
+		return;
+	}
+
+	_referenceCount = 1;
+	_glitchedPixels = MarkGlitches(fractalArray, tiles);
+
+	size_t glitched = _glitchedPixels;
+	size_t glitchTiles = 0;
+	const double refX = SimWidth() / 2, refY = SimHeight() / 2;
+	const int limbs = _reference.Cr().FractionLimbs();
+	while (glitched > 0 && _referenceCount < MaxReferences && !Cancelled())
+	{
+		// Offset the same way the workers compute a pixel's offset, so the two references agree
+		const auto [x, y] = PickReference(tiles);
+		const BigReal cr = _reference.Cr() + BigReal(ExtendedReal(-refX * _xScale + x * _xScale, _exponent), limbs);
+		const BigReal ci = _reference.Ci() + BigReal(ExtendedReal(-refY * _yScale + y * _yScale, _exponent), limbs);
+		_secondary.Compute(cr, ci, ComputeIterations(), [this] { return Cancelled(); });
+		_orbitSeconds += _secondary.Seconds();
+		if (Cancelled())
+		{
+			break;
+		}
+		if (_approximation)
+		{
+			_secondaryBla.Build(_secondary, _blaOffset);
+			_orbitSeconds += _secondaryBla.Seconds();
+		}
+
+		UseReference(_secondary, _secondaryBla, x, y);
+		// The tile counts are about the frame's own tiles, the ones done again are counted apart
+		std::vector<WorkerStats> counts;
+		for (auto& worker : Workers())
+		{
+			worker->Step = 1;
+			worker->Refine = false;
+			worker->States = _glitchStates.data();
+			worker->Subdivide = false;
+			counts.push_back(worker->Stats);
+		}
+		Dispatch(tiles, TileSize());
+		for (size_t i = 0; i < Workers().size(); i++)
+		{
+			auto& stats = Workers()[i]->Stats;
+			glitchTiles += stats.Tiles - counts[i].Tiles;
+			stats.Tiles = counts[i].Tiles;
+			stats.StolenTiles = counts[i].StolenTiles;
+			stats.PrecisionTiles = counts[i].PrecisionTiles;
+		}
+
+		_referenceCount++;
+		glitched = MarkGlitches(fractalArray, tiles);
+	}
+
+	// Better a pixel off than a hole
+	_unresolvedPixels = glitched;
+	_glitchTiles = glitchTiles;
+	if (glitched > 0)
+	{
+		for (const auto& tile : tiles)
+		{
+			for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+			{
+				int* row = fractalArray + y * SimWidth() + tile.X;
+				std::replace(row, row + tile.Width, Kernels::GlitchedPixel, 0);
+			}
+		}
+	}
+}
+
+void PerturbationHost::UseReference(const ReferenceOrbit& orbit, const BlaTable& bla, double x, double y)
+{
+	auto view = orbit.View();
+	if (_approximation)
+	{
+		view.Bla = bla.Levels().data();
+		view.BlaLevels = static_cast<int>(bla.Levels().size());
+	}
+
+	for (auto& worker : Workers())
+	{
+		auto& perturbationWorker = static_cast<PerturbationWorker&>(*worker);
+		perturbationWorker.Orbit = view;
+		perturbationWorker.OffsetTL = Position(-x * _xScale, -y * _yScale);
+		perturbationWorker.OffsetXScale = _xScale;
+		perturbationWorker.OffsetYScale = _yScale;
+		perturbationWorker.OffsetExponent = _exponent;
+	}
+}
+
+auto PerturbationHost::MarkGlitches(const int* fractalArray, const std::vector<Tile>& tiles) -> size_t
+{
+	_glitchStates.assign(SimWidth() * SimHeight(), PixelState::Fresh);
+
+	size_t glitched = 0;
+	for (const auto& tile : tiles)
+	{
+		for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+		{
+			for (int x = tile.X; x < tile.X + tile.Width; x++)
+			{
+				const int i = y * SimWidth() + x;
+				if (fractalArray[i] == Kernels::GlitchedPixel)
+				{
+					_glitchStates[i] = PixelState::Missing;
+					glitched++;
+				}
+			}
+		}
+	}
+	return glitched;
+}
+
+auto PerturbationHost::PickReference(const std::vector<Tile>& tiles) const -> std::pair<int, int>
+{
+	double sumX = 0.0, sumY = 0.0, count = 0.0;
+	for (const auto& tile : tiles)
+	{
+		for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+		{
+			for (int x = tile.X; x < tile.X + tile.Width; x++)
+			{
+				if (_glitchStates[y * SimWidth() + x] == PixelState::Missing)
+				{
+					sumX += x;
+					sumY += y;
+					count += 1.0;
+				}
+			}
+		}
+	}
+
+	const Position centroid(sumX / count, sumY / count);
+	std::pair<int, int> best = {0, 0};
+	double bestDistance = std::numeric_limits<double>::max();
+	for (const auto& tile : tiles)
+	{
+		for (int y = tile.Y; y < tile.Y + tile.Height; y++)
+		{
+			for (int x = tile.X; x < tile.X + tile.Width; x++)
+			{
+				const double distance = VecUtils::LengthSq(Position(x, y) - centroid);
+				if (_glitchStates[y * SimWidth() + x] == PixelState::Missing && distance < bestDistance)
+				{
+					best = {x, y};
+					bestDistance = distance;
+				}
+			}
+		}
+	}
+	return best;
+}
+}
@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include "ComputeHosts/CpuHost.h"
+#include "Perturbation/BlaTable.h"
+#include "Perturbation/ReferenceOrbit.h"
+
+namespace Se
+{
+// Mandelbrot past the resolution of double. One reference orbit at the centre of the view is
+// iterated at full precision, every pixel only iterates its double offset from it with the SIMD
+// kernels. Pixels the reference cannot resolve get references of their own. Views and tiles the
+// plain kernels can resolve skip the reference and use those instead.
+class PerturbationHost : public CpuHost
+{
+public:
+	// Bits kept beyond the pixel spacing in the reference orbit
+	static constexpr int GuardBits = 64;
+	// References per frame, the first included, before glitches are given up on
+	static constexpr int MaxReferences = 16;
+
+	PerturbationHost(int simWidth, int simHeight);
+	~PerturbationHost() override;
+
+	auto OrbitLength() const -> size_t;
+	auto OrbitBits() const -> int;
+	// Time spent on reference orbits last frame
+	auto OrbitSeconds() const -> double;
+	auto ReferenceCount() const -> int;
+	// Pixels the first reference left glitched, and the ones still glitched after the last
+	auto GlitchedPixels() const -> size_t;
+	auto UnresolvedPixels() const -> size_t;
+	// Tiles computed again with further references. The workers' tile counts leave them out.
+	auto GlitchTiles() const -> size_t;
+
+	// Skip runs of iterations with the reference's linear approximations
+	auto Approximation() const -> bool;
+	void SetApproximation(bool approximation);
+	auto ApproximatedIterations() const -> size_t;
+	// Lane iterations spent on offsets below double's range
+	auto ExtendedIterations() const -> size_t;
+
+private:
+	auto ChoosePrecision(const struct SimBox& simBox, size_t iterations) const -> Kernels::Precision override;
+	void PrepareWorkers(const struct SimBox& simBox) override;
+	void FinishTiles(int* fractalArray, const std::vector<Tile>& tiles) override;
+	auto CacheParameters() const -> uint64_t override;
+
+	// Points the workers at orbit, whose reference is the pixel at (x, y)
+	void UseReference(const ReferenceOrbit& orbit, const BlaTable& bla, double x, double y);
+	// Marks the glitched pixels of the tiles Missing, everything else Fresh
+	auto MarkGlitches(const int* fractalArray, const std::vector<Tile>& tiles) -> size_t;
+	// The glitched pixel closest to the middle of all glitched ones
+	auto PickReference(const std::vector<Tile>& tiles) const -> std::pair<int, int>;
+
+private:
+	struct PerturbationWorker : Worker
+	{
+		void ComputeSpan(int x, int y, int count, int stride) override;
+		void ComputeRuns(const std::vector<Run>& runs) override;
+		auto SupportsSubdivision() const -> bool override { return true; }
+
+		Kernels::Orbit Orbit;
+		// Pixel (x, y) is OffsetTL + (x * OffsetXScale, y * OffsetYScale) away from the reference,
+		// in units of 2^OffsetExponent
+		Position OffsetTL = {0.0, 0.0};
+		double OffsetXScale = 0.0;
+		double OffsetYScale = 0.0;
+		int64_t OffsetExponent = 0;
+	};
+
+	ReferenceOrbit _reference;
+	ReferenceOrbit _secondary;
+	BlaTable _referenceBla;
+	BlaTable _secondaryBla;
+	bool _approximation = true;
+	// Largest pixel offset the reference's table was built for
+	double _blaOffset = 0.0;
+	// Pixel spacing in units of 2^_exponent, which stays 0 while double can hold the offsets
+	double _xScale = 0.0, _yScale = 0.0;
+	int64_t _exponent = 0;
+	// Written by the frame in the background while the GUI reads them
+	std::atomic<size_t> _orbitLength = 0;
+	std::atomic<int> _orbitBits = 0;
+	std::atomic<double> _orbitSeconds = 0.0;
+	std::atomic<int> _referenceCount = 0;
+	std::atomic<size_t> _glitchedPixels = 0;
+	std::atomic<size_t> _unresolvedPixels = 0;
+	std::atomic<size_t> _glitchTiles = 0;
+	std::vector<PixelState> _glitchStates;
+};
+}
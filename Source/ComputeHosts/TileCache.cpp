@@ -0,0 +1,208 @@
+﻿#include "ComputeHosts/TileCache.h"
+
+#include <algorithm>
+
+#include "ComputeHosts/TileStore.h"
+
+namespace Se
+{
+namespace
+{
+constexpr size_t TileBytes = TileCache::TileSize * TileCache::TileSize * sizeof(int);
+}
+
+auto TileKeyHash::operator()(const TileKey& key) const -> size_t
+{
+	return TileCache::Combine(TileCache::Combine(key.Parameters, key.X), key.Y);
+}
+
+TileCache::TileCache() :
+	_store(std::make_unique<TileStore>())
+{
+	if (!_store->Open(DefaultStorePath))
+	{
+		_store.reset();
+	}
+}
+
+TileCache::~TileCache()
+{
+	Flush();
+}
+
+auto TileCache::Instance() -> TileCache&
+{
+	static TileCache cache;
+	return cache;
+}
+
+auto TileCache::Combine(uint64_t seed, uint64_t value) -> uint64_t
+{
+	// splitmix64 of the value, folded in the way boost::hash_combine does
+	value += 0x9e3779b97f4a7c15;
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+	value ^= value >> 31;
+	return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+}
+
+auto TileCache::Find(const TileKey& key, std::vector<int>& pixels) -> bool
+{
+	std::scoped_lock lock(_mutex);
+	if (const auto it = _index.find(key); it != _index.end())
+	{
+		_entries.splice(_entries.begin(), _entries, it->second);
+		pixels = it->second->Pixels;
+		_hits++;
+		return true;
+	}
+
+	if (_store && _store->Find(key, pixels))
+	{
+		Insert({key, pixels, false});
+		_storeHits++;
+		return true;
+	}
+	_misses++;
+	return false;
+}
+
+void TileCache::Store(const TileKey& key, const std::vector<int>& pixels)
+{
+	std::scoped_lock lock(_mutex);
+	if (const auto it = _index.find(key); it != _index.end())
+	{
+		auto& entry = *it->second;
+		for (size_t i = 0; i < entry.Pixels.size(); i++)
+		{
+			if (entry.Pixels[i] == Hole && pixels[i] != Hole)
+			{
+				entry.Pixels[i] = pixels[i];
+				entry.Dirty = true;
+			}
+		}
+		_entries.splice(_entries.begin(), _entries, it->second);
+		return;
+	}
+
+	// A tile evicted before may still have pixels on disk this one lacks
+	std::vector<int> stored;
+	if (_store && _store->Find(key, stored))
+	{
+		bool filled = false;
+		for (size_t i = 0; i < stored.size(); i++)
+		{
+			if (stored[i] == Hole && pixels[i] != Hole)
+			{
+				stored[i] = pixels[i];
+				filled = true;
+			}
+		}
+		Insert({key, std::move(stored), filled});
+		return;
+	}
+	Insert({key, pixels});
+}
+
+void TileCache::Clear()
+{
+	std::scoped_lock lock(_mutex);
+	_entries.clear();
+	_index.clear();
+	if (_store)
+	{
+		_store->Clear();
+	}
+}
+
+void TileCache::Flush()
+{
+	std::scoped_lock lock(_mutex);
+	for (auto& entry : _entries)
+	{
+		Write(entry);
+	}
+}
+
+auto TileCache::DiskStore() const -> const TileStore*
+{
+	return _store.get();
+}
+
+auto TileCache::Budget() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _budget;
+}
+
+void TileCache::SetBudget(size_t bytes)
+{
+	std::scoped_lock lock(_mutex);
+	_budget = bytes;
+	Evict();
+}
+
+auto TileCache::Bytes() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _entries.size() * TileBytes;
+}
+
+auto TileCache::TileCount() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _entries.size();
+}
+
+auto TileCache::Hits() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _hits;
+}
+
+auto TileCache::StoreHits() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _storeHits;
+}
+
+auto TileCache::Misses() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _misses;
+}
+
+auto TileCache::Evictions() const -> size_t
+{
+	std::scoped_lock lock(_mutex);
+	return _evictions;
+}
+
+void TileCache::Insert(Entry entry)
+{
+	const TileKey key = entry.Key;
+	_entries.push_front(std::move(entry));
+	_index.emplace(key, _entries.begin());
+	Evict();
+}
+
+void TileCache::Evict()
+{
+	while (!_entries.empty() && _entries.size() * TileBytes > _budget)
+	{
+		Write(_entries.back());
+		_index.erase(_entries.back().Key);
+		_entries.pop_back();
+		_evictions++;
+	}
+}
+
+void TileCache::Write(Entry& entry)
+{
+	if (entry.Dirty && _store)
+	{
+		_store->Store(entry.Key, entry.Pixels);
+		entry.Dirty = false;
+	}
+}
+}
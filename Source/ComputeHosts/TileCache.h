@@ -0,0 +1,99 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Se
+{
+// A tile on the pixel grid shared by every view with the same spacing and sub-pixel phase.
+// Parameters covers all else the pixels depend on, the grid included.
+struct TileKey
+{
+	uint64_t Parameters = 0;
+	int64_t X = 0, Y = 0;
+
+	auto operator==(const TileKey& other) const -> bool = default;
+};
+
+struct TileKeyHash
+{
+	auto operator()(const TileKey& key) const -> size_t;
+};
+
+class TileStore;
+
+// Finished tiles of earlier views, so coming back to one does not compute it again. Least
+// recently used tiles go once the cache is over its budget, to the tile store on disk if it
+// is open, and come back from there when asked for again. Shared by every CPU host.
+class TileCache
+{
+public:
+	// Pixels along the side of a cached tile
+	static constexpr int TileSize = 64;
+	// Marks pixels a cached tile holds no result for
+	static constexpr int Hole = std::numeric_limits<int>::min();
+	static constexpr size_t DefaultBudget = size_t(256) << 20;
+	static constexpr const char* DefaultStorePath = "Cache/Tiles.bin";
+
+	TileCache();
+	~TileCache();
+
+	static auto Instance() -> TileCache&;
+	// Mixes a value into a parameter hash
+	static auto Combine(uint64_t seed, uint64_t value) -> uint64_t;
+
+	// Copies a cached tile of TileSize * TileSize pixels, row by row, and marks it most recently used
+	auto Find(const TileKey& key, std::vector<int>& pixels) -> bool;
+	// Adds a tile, or fills in the holes of the one already cached
+	void Store(const TileKey& key, const std::vector<int>& pixels);
+	// Drops every tile, the ones on disk too
+	void Clear();
+	// Writes the tiles the store does not have yet, done on destruction too
+	void Flush();
+	// Null when the store could not be opened
+	auto DiskStore() const -> const TileStore*;
+
+	// Bytes of pixels the cache may hold
+	auto Budget() const -> size_t;
+	void SetBudget(size_t bytes);
+	auto Bytes() const -> size_t;
+	auto TileCount() const -> size_t;
+
+	// Finds in memory, finds on disk, and finds in neither
+	auto Hits() const -> size_t;
+	auto StoreHits() const -> size_t;
+	auto Misses() const -> size_t;
+	auto Evictions() const -> size_t;
+
+private:
+	struct Entry
+	{
+		TileKey Key;
+		std::vector<int> Pixels;
+		// Not in the store, or holes filled since
+		bool Dirty = true;
+	};
+
+	void Insert(Entry entry);
+	void Evict();
+	void Write(Entry& entry);
+
+private:
+	// Most recently used first
+	std::list<Entry> _entries;
+	std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> _index;
+	std::unique_ptr<TileStore> _store;
+	mutable std::mutex _mutex;
+
+	size_t _budget = DefaultBudget;
+	size_t _hits = 0;
+	size_t _storeHits = 0;
+	size_t _misses = 0;
+	size_t _evictions = 0;
+};
+}
@@ -0,0 +1,186 @@
+﻿#include "ComputeHosts/TileScheduler.h"
+
+#include <algorithm>
+
+namespace Se
+{
+void TileScheduler::Schedule(int width, int height, int tileSize, size_t queueCount)
+{
+	Schedule({{0, 0, width, height}}, tileSize, queueCount);
+}
+
+void TileScheduler::Schedule(const std::vector<Tile>& regions, int tileSize, size_t queueCount)
+{
+	Distribute(Split(regions, tileSize), queueCount, false);
+}
+
+void TileScheduler::Schedule(const std::vector<Tile>& regions, int tileSize, size_t queueCount,
+                             const TileFocus& focus)
+{
+	auto tiles = Split(regions, tileSize);
+	const auto distance = [&focus](const Tile& tile)
+	{
+		const float dx = tile.X + tile.Width * 0.5f - focus.X;
+		const float dy = tile.Y + tile.Height * 0.5f - focus.Y;
+		return dx * dx + dy * dy;
+	};
+	std::stable_sort(tiles.begin(), tiles.end(), [&](const Tile& a, const Tile& b)
+	{
+		return distance(a) < distance(b);
+	});
+	Distribute(tiles, queueCount, true);
+}
+
+auto TileScheduler::Next(size_t queueIndex, Tile& tile, bool& stolen) -> bool
+{
+	{
+		auto& own = *_queues[queueIndex];
+		std::scoped_lock lock(own.Mutex);
+		if (!own.Tiles.empty())
+		{
+			tile = own.Tiles.front();
+			own.Tiles.pop_front();
+			own.Issued.push_back(tile);
+			stolen = false;
+			return true;
+		}
+	}
+
+	stolen = Steal(queueIndex, tile);
+	return stolen;
+}
+
+void TileScheduler::Cancel()
+{
+	for (auto& queue : _queues)
+	{
+		std::scoped_lock lock(queue->Mutex);
+		queue->Tiles.clear();
+	}
+}
+
+void TileScheduler::SetDeadline(std::optional<Clock::time_point> deadline)
+{
+	_deadline = deadline;
+}
+
+auto TileScheduler::Expired() const -> bool
+{
+	return _deadline && Clock::now() >= *_deadline;
+}
+
+auto TileScheduler::Remaining() -> std::vector<Tile>
+{
+	std::vector<Tile> tiles;
+	for (auto& queue : _queues)
+	{
+		std::scoped_lock lock(queue->Mutex);
+		tiles.insert(tiles.end(), queue->Tiles.begin(), queue->Tiles.end());
+		queue->Tiles.clear();
+	}
+	return tiles;
+}
+
+auto TileScheduler::Issued() const -> std::vector<Tile>
+{
+	std::vector<Tile> tiles;
+	for (const auto& queue : _queues)
+	{
+		std::scoped_lock lock(queue->Mutex);
+		tiles.insert(tiles.end(), queue->Issued.begin(), queue->Issued.end());
+	}
+	return tiles;
+}
+
+auto TileScheduler::TileCount() const -> size_t
+{
+	return _tileCount;
+}
+
+auto TileScheduler::Steal(size_t thiefIndex, Tile& tile) -> bool
+{
+	// Queues only ever shrink while a frame is running, so this terminates
+	while (true)
+	{
+		Queue* victim = nullptr;
+		size_t most = 0;
+		for (size_t i = 0; i < _queues.size(); i++)
+		{
+			if (i == thiefIndex)
+			{
+				continue;
+			}
+			std::scoped_lock lock(_queues[i]->Mutex);
+			if (_queues[i]->Tiles.size() > most)
+			{
+				most = _queues[i]->Tiles.size();
+				victim = _queues[i].get();
+			}
+		}
+
+		if (victim == nullptr)
+		{
+			return false;
+		}
+
+		std::scoped_lock lock(victim->Mutex);
+		if (!victim->Tiles.empty())
+		{
+			tile = victim->Tiles.back();
+			victim->Tiles.pop_back();
+			victim->Issued.push_back(tile);
+			return true;
+		}
+	}
+}
+
+auto TileScheduler::Split(const std::vector<Tile>& regions, int tileSize) -> std::vector<Tile>
+{
+	std::vector<Tile> tiles;
+	for (const auto& region : regions)
+	{
+		const int xEnd = region.X + region.Width;
+		const int yEnd = region.Y + region.Height;
+		for (int y = region.Y; y < yEnd; y += tileSize)
+		{
+			for (int x = region.X; x < xEnd; x += tileSize)
+			{
+				tiles.push_back({x, y, std::min(tileSize, xEnd - x), std::min(tileSize, yEnd - y)});
+			}
+		}
+	}
+	return tiles;
+}
+
+void TileScheduler::Distribute(const std::vector<Tile>& tiles, size_t queueCount, bool interleave)
+{
+	while (_queues.size() < queueCount)
+	{
+		_queues.emplace_back(std::make_unique<Queue>());
+	}
+	_queues.resize(queueCount);
+
+	for (size_t i = 0; i < queueCount; i++)
+	{
+		std::scoped_lock lock(_queues[i]->Mutex);
+		auto& queue = _queues[i]->Tiles;
+		queue.clear();
+		_queues[i]->Issued.clear();
+		if (interleave)
+		{
+			for (size_t j = i; j < tiles.size(); j += queueCount)
+			{
+				queue.push_back(tiles[j]);
+			}
+		}
+		else
+		{
+			// Contiguous runs keep neighbouring tiles on the same core, stealing evens out the rest
+			const auto first = tiles.begin() + tiles.size() * i / queueCount;
+			const auto last = tiles.begin() + tiles.size() * (i + 1) / queueCount;
+			queue.assign(first, last);
+		}
+	}
+	_tileCount = tiles.size();
+}
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Se
+{
+struct Tile
+{
+	int X = 0, Y = 0;
+	int Width = 0, Height = 0;
+};
+
+// A pixel the tiles around it are computed first for
+struct TileFocus
+{
+	float X = 0.0f, Y = 0.0f;
+};
+
+// Splits the image into square tiles and hands every worker a contiguous run of them.
+// A worker pops from the front of its own deque and, once empty, steals from the back
+// of the fullest other deque.
+class TileScheduler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	void Schedule(int width, int height, int tileSize, size_t queueCount);
+	// Only tiles the given rectangles, used when most of the image is already computed
+	void Schedule(const std::vector<Tile>& regions, int tileSize, size_t queueCount);
+	// Orders the tiles by their distance to the focus instead and deals them out in turn, so every
+	// worker starts next to it and the tiles furthest away are the ones left to steal
+	void Schedule(const std::vector<Tile>& regions, int tileSize, size_t queueCount, const TileFocus& focus);
+
+	auto Next(size_t queueIndex, Tile& tile, bool& stolen) -> bool;
+	// Drops every queued tile, workers stop once the tile they are on is done
+	void Cancel();
+
+	// Workers stop taking tiles once it has passed, Remaining hands back the ones they left
+	void SetDeadline(std::optional<Clock::time_point> deadline);
+	auto Expired() const -> bool;
+	// Empties the queues, only call while no worker is running
+	auto Remaining() -> std::vector<Tile>;
+	// Tiles some worker took since the last Schedule, only call while no worker is running
+	auto Issued() const -> std::vector<Tile>;
+
+	auto TileCount() const -> size_t;
+
+	// The tiles Schedule makes of the regions, in the order it makes them
+	static auto Split(const std::vector<Tile>& regions, int tileSize) -> std::vector<Tile>;
+
+private:
+	auto Steal(size_t thiefIndex, Tile& tile) -> bool;
+	void Distribute(const std::vector<Tile>& tiles, size_t queueCount, bool interleave);
+
+private:
+	struct Queue
+	{
+		std::deque<Tile> Tiles;
+		// Taken from this queue, by its own worker or a thief
+		std::vector<Tile> Issued;
+		std::mutex Mutex;
+	};
+
+	std::vector<std::unique_ptr<Queue>> _queues;
+	// Read by the GUI while a frame is being scheduled
+	std::atomic<size_t> _tileCount = 0;
+	std::optional<Clock::time_point> _deadline;
+};
+}
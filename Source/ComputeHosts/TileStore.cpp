@@ -0,0 +1,442 @@
+﻿#include "ComputeHosts/TileStore.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Se
+{
+namespace
+{
+constexpr char Magic[8] = {'F', 'R', 'T', 'I', 'L', 'E', 'S', '1'};
+constexpr uint64_t HeaderSize = sizeof(Magic) + 2 * sizeof(uint32_t);
+// Parameters, X, Y and the size of the runs that follow
+constexpr uint64_t RecordHeaderSize = 3 * sizeof(uint64_t) + sizeof(uint32_t);
+constexpr size_t TilePixels = TileCache::TileSize * TileCache::TileSize;
+// Superseded records are only rewritten away once there are this many bytes of them
+constexpr uint64_t MinCompactBytes = uint64_t(16) << 20;
+constexpr uint64_t CompactedBytes = TileStore::MaxBytes / 4 * 3;
+
+void PutVarint(std::vector<uint8_t>& bytes, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+auto GetVarint(const uint8_t*& bytes, const uint8_t* end, uint64_t& value) -> bool
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && bytes < end; shift += 7)
+	{
+		const uint8_t byte = *bytes++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+template <class T>
+void Append(std::vector<uint8_t>& bytes, const T& value)
+{
+	const auto* raw = reinterpret_cast<const uint8_t*>(&value);
+	bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+}
+
+TileStore::~TileStore()
+{
+	Close();
+}
+
+auto TileStore::Open(const std::filesystem::path& path) -> bool
+{
+	Close();
+	_path = path;
+
+	std::error_code error;
+	if (_path.has_parent_path())
+	{
+		std::filesystem::create_directories(_path.parent_path(), error);
+	}
+
+	// Start over on anything that is not a store of the current tile size
+	const uint32_t tileSize = TileCache::TileSize;
+	bool valid = false;
+	{
+		std::ifstream file(_path, std::ios::binary);
+		char magic[sizeof(Magic)] = {};
+		uint32_t storedTileSize = 0;
+		valid = file.read(magic, sizeof(magic)) &&
+			file.read(reinterpret_cast<char*>(&storedTileSize), sizeof(storedTileSize)) &&
+			std::memcmp(magic, Magic, sizeof(Magic)) == 0 && storedTileSize == tileSize;
+	}
+	if (!valid)
+	{
+		std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+		const uint32_t reserved = 0;
+		file.write(Magic, sizeof(Magic));
+		file.write(reinterpret_cast<const char*>(&tileSize), sizeof(tileSize));
+		file.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+		if (!file)
+		{
+			return false;
+		}
+	}
+
+	_fileSize = std::filesystem::file_size(_path, error);
+	if (error || !Index())
+	{
+		Release();
+		return false;
+	}
+	Compact();
+	_file.open(_path, std::ios::binary | std::ios::app);
+	return _file.is_open();
+}
+
+void TileStore::Close()
+{
+	_file.close();
+	if (!_records.empty())
+	{
+		Compact();
+	}
+	Release();
+}
+
+void TileStore::Release()
+{
+	Unmap();
+	_file.close();
+	_records.clear();
+	_fileSize = 0;
+	_liveBytes = 0;
+}
+
+auto TileStore::Find(const TileKey& key, std::vector<int>& pixels) -> bool
+{
+	const auto it = _records.find(key);
+	if (it == _records.end())
+	{
+		return false;
+	}
+
+	const auto& record = it->second;
+	if (record.Offset + record.Size > _mappedSize)
+	{
+		_file.flush();
+		if (!Map())
+		{
+			return false;
+		}
+	}
+	pixels.resize(TilePixels);
+	return Decode(_mapped + record.Offset, record.Size, pixels.data(), pixels.size());
+}
+
+void TileStore::Store(const TileKey& key, const std::vector<int>& pixels)
+{
+	if (!_file.is_open())
+	{
+		return;
+	}
+
+	Encode(pixels, _encoded);
+	const uint64_t recordSize = RecordHeaderSize + _encoded.size();
+	if (_fileSize + recordSize > MaxBytes)
+	{
+		// Windows cannot replace the file while it is open for writing
+		_file.close();
+		Compact(recordSize);
+		_file.open(_path, std::ios::binary | std::ios::app);
+		if (!_file.is_open() || _fileSize + recordSize > MaxBytes)
+		{
+			return;
+		}
+	}
+
+	std::vector<uint8_t> header;
+	Append(header, key.Parameters);
+	Append(header, key.X);
+	Append(header, key.Y);
+	Append(header, static_cast<uint32_t>(_encoded.size()));
+
+	_file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+	_file.write(reinterpret_cast<const char*>(_encoded.data()), static_cast<std::streamsize>(_encoded.size()));
+	if (!_file)
+	{
+		// Leave the store as it was indexed, a partly written record is dropped on the next open
+		_file.close();
+		return;
+	}
+
+	Track(key, {_fileSize + RecordHeaderSize, static_cast<uint32_t>(_encoded.size())});
+	_fileSize += RecordHeaderSize + _encoded.size();
+}
+
+void TileStore::Clear()
+{
+	const auto path = _path;
+	Release();
+	std::error_code error;
+	std::filesystem::remove(path, error);
+	Open(path);
+}
+
+auto TileStore::TileCount() const -> size_t
+{
+	return _records.size();
+}
+
+auto TileStore::Bytes() const -> size_t
+{
+	return _fileSize;
+}
+
+auto TileStore::LiveBytes() const -> size_t
+{
+	return _liveBytes;
+}
+
+void TileStore::Encode(const std::vector<int>& pixels, std::vector<uint8_t>& bytes)
+{
+	bytes.clear();
+	int64_t previous = 0;
+	for (size_t i = 0; i < pixels.size();)
+	{
+		size_t end = i + 1;
+		while (end < pixels.size() && pixels[end] == pixels[i])
+		{
+			end++;
+		}
+
+		// Zigzag so small steps either way stay short
+		const int64_t delta = pixels[i] - previous;
+		PutVarint(bytes, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+		PutVarint(bytes, end - i);
+		previous = pixels[i];
+		i = end;
+	}
+}
+
+auto TileStore::Decode(const uint8_t* bytes, size_t size, int* pixels, size_t count) -> bool
+{
+	const uint8_t* end = bytes + size;
+	int64_t value = 0;
+	size_t filled = 0;
+	while (bytes < end)
+	{
+		uint64_t zigzag = 0, length = 0;
+		if (!GetVarint(bytes, end, zigzag) || !GetVarint(bytes, end, length) || length > count - filled)
+		{
+			return false;
+		}
+		value += static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+		std::fill_n(pixels + filled, length, static_cast<int>(value));
+		filled += length;
+	}
+	return filled == count;
+}
+
+auto TileStore::Index() -> bool
+{
+	if (_fileSize > HeaderSize && !Map())
+	{
+		return false;
+	}
+
+	uint64_t offset = HeaderSize;
+	while (offset + RecordHeaderSize <= _mappedSize)
+	{
+		TileKey key;
+		uint32_t size = 0;
+		const uint8_t* header = _mapped + offset;
+		std::memcpy(&key.Parameters, header, sizeof(uint64_t));
+		std::memcpy(&key.X, header + sizeof(uint64_t), sizeof(int64_t));
+		std::memcpy(&key.Y, header + 2 * sizeof(uint64_t), sizeof(int64_t));
+		std::memcpy(&size, header + 3 * sizeof(uint64_t), sizeof(uint32_t));
+		if (offset + RecordHeaderSize + size > _mappedSize)
+		{
+			break;
+		}
+		Track(key, {offset + RecordHeaderSize, size});
+		offset += RecordHeaderSize + size;
+	}
+
+	// A record cut short by a crash is dropped so the next one appends cleanly
+	if (offset < _fileSize)
+	{
+		Unmap();
+		std::error_code error;
+		std::filesystem::resize_file(_path, offset, error);
+		if (error)
+		{
+			return false;
+		}
+		_fileSize = offset;
+	}
+	return true;
+}
+
+void TileStore::Track(const TileKey& key, const Record& record)
+{
+	auto& current = _records[key];
+	if (current.Offset != 0)
+	{
+		_liveBytes -= RecordHeaderSize + current.Size;
+	}
+	current = record;
+	_liveBytes += RecordHeaderSize + record.Size;
+}
+
+void TileStore::Compact(uint64_t extra)
+{
+	const uint64_t superseded = _fileSize - HeaderSize - _liveBytes;
+	if (_fileSize + extra <= MaxBytes && (superseded < MinCompactBytes || superseded < _liveBytes))
+	{
+		return;
+	}
+	if (_mappedSize < _fileSize && !Map())
+	{
+		return;
+	}
+
+	// Records are in the order they were written, the newest are kept while they fit
+	std::vector<std::pair<TileKey, Record>> records(_records.begin(), _records.end());
+	std::sort(records.begin(), records.end(), [](const auto& a, const auto& b)
+	{
+		return a.second.Offset > b.second.Offset;
+	});
+	uint64_t kept = HeaderSize;
+	size_t count = 0;
+	while (count < records.size() && kept + RecordHeaderSize + records[count].second.Size <= CompactedBytes)
+	{
+		kept += RecordHeaderSize + records[count].second.Size;
+		count++;
+	}
+	records.resize(count);
+	std::reverse(records.begin(), records.end());
+
+	auto compacted = _path;
+	compacted += ".tmp";
+	std::unordered_map<TileKey, Record, TileKeyHash> moved;
+	{
+		std::ofstream file(compacted, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(_mapped), HeaderSize);
+		uint64_t offset = HeaderSize;
+		for (const auto& [key, record] : records)
+		{
+			const uint64_t size = RecordHeaderSize + record.Size;
+			file.write(reinterpret_cast<const char*>(_mapped + record.Offset - RecordHeaderSize),
+			           static_cast<std::streamsize>(size));
+			moved[key] = {offset + RecordHeaderSize, record.Size};
+			offset += size;
+		}
+		if (!file.flush())
+		{
+			file.close();
+			std::error_code error;
+			std::filesystem::remove(compacted, error);
+			return;
+		}
+	}
+
+	// The mapping has to go before the file can be replaced on Windows
+	Unmap();
+	std::error_code error;
+	std::filesystem::rename(compacted, _path, error);
+	if (error)
+	{
+		std::filesystem::remove(compacted, error);
+		return;
+	}
+	_records = std::move(moved);
+	_fileSize = kept;
+	_liveBytes = kept - HeaderSize;
+}
+
+auto TileStore::Map() -> bool
+{
+	Unmap();
+	if (_fileSize == 0)
+	{
+		return false;
+	}
+
+#if defined(_WIN32)
+	_fileHandle = CreateFileW(_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+	                          nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		_fileHandle = nullptr;
+		return false;
+	}
+	_mappingHandle = CreateFileMappingW(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = _mappingHandle != nullptr ? MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (view == nullptr)
+	{
+		Unmap();
+		return false;
+	}
+#else
+	const int descriptor = open(_path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		return false;
+	}
+	void* view = mmap(nullptr, _fileSize, PROT_READ, MAP_SHARED, descriptor, 0);
+	close(descriptor);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+#endif
+
+	_mapped = static_cast<const uint8_t*>(view);
+	_mappedSize = _fileSize;
+	return true;
+}
+
+void TileStore::Unmap()
+{
+#if defined(_WIN32)
+	if (_mapped != nullptr)
+	{
+		UnmapViewOfFile(_mapped);
+	}
+	if (_mappingHandle != nullptr)
+	{
+		CloseHandle(_mappingHandle);
+	}
+	if (_fileHandle != nullptr)
+	{
+		CloseHandle(_fileHandle);
+	}
+	_mappingHandle = nullptr;
+	_fileHandle = nullptr;
+#else
+	if (_mapped != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(_mapped), _mappedSize);
+	}
+#endif
+	_mapped = nullptr;
+	_mappedSize = 0;
+}
+}
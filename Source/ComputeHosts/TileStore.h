@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include "ComputeHosts/TileCache.h"
+
+namespace Se
+{
+// Tiles of the tile cache kept on disk across runs. Records are appended to a single file and
+// read back through a memory mapping of it, a tile written again supersedes the earlier record.
+// Each record is the tile's key followed by its pixels as runs: the change from the previous
+// run's value and the run's length, both as variable length integers. Interior and escaped
+// regions are long runs of one value, so most tiles take a few hundred bytes.
+// Opening and closing the store compacts the file once superseded records take up most of it.
+// The file never grows past MaxBytes, a record that would take it there compacts it first and
+// the oldest tiles are dropped to leave room.
+class TileStore
+{
+public:
+	static constexpr uint64_t MaxBytes = uint64_t(1) << 30;
+
+public:
+	TileStore() = default;
+	~TileStore();
+
+	TileStore(const TileStore&) = delete;
+	auto operator=(const TileStore&) -> TileStore& = delete;
+
+	// Creates the file if needed and indexes the records in it. Records cut short by a crash,
+	// and files of another format or tile size, are dropped.
+	auto Open(const std::filesystem::path& path) -> bool;
+	void Close();
+
+	// Tiles are decoded from the mapping straight into pixels, which is resized to a whole tile
+	auto Find(const TileKey& key, std::vector<int>& pixels) -> bool;
+	// Appends the tile, superseding any earlier record of it. Nothing is stored while the file
+	// cannot be written or compacted below MaxBytes.
+	void Store(const TileKey& key, const std::vector<int>& pixels);
+	void Clear();
+
+	auto TileCount() const -> size_t;
+	// Size of the file, superseded records included
+	auto Bytes() const -> size_t;
+	// Size of the records that are still current
+	auto LiveBytes() const -> size_t;
+
+	static void Encode(const std::vector<int>& pixels, std::vector<uint8_t>& bytes);
+	// False when the bytes do not decode to exactly count pixels
+	static auto Decode(const uint8_t* bytes, size_t size, int* pixels, size_t count) -> bool;
+
+private:
+	struct Record
+	{
+		uint64_t Offset = 0;
+		uint32_t Size = 0;
+	};
+
+	auto Index() -> bool;
+	void Track(const TileKey& key, const Record& record);
+	// Rewrites the current records to a new file when enough of the old one is superseded or it
+	// would go over MaxBytes with another extra bytes. Only the newest records up to three
+	// quarters of MaxBytes are kept, so a full store is not compacted again on every write.
+	// Leaves the file as it was when that fails.
+	void Compact(uint64_t extra = 0);
+	// Close without compacting
+	void Release();
+	// Maps the file as far as it is written, the mapping is redone when reads go past it
+	auto Map() -> bool;
+	void Unmap();
+
+private:
+	std::filesystem::path _path;
+	std::ofstream _file;
+	uint64_t _fileSize = 0;
+	uint64_t _liveBytes = 0;
+	std::unordered_map<TileKey, Record, TileKeyHash> _records;
+	std::vector<uint8_t> _encoded;
+
+	const uint8_t* _mapped = nullptr;
+	uint64_t _mappedSize = 0;
+#if defined(_WIN32)
+	void* _fileHandle = nullptr;
+	void* _mappingHandle = nullptr;
+#endif
+};
+}
@@ -0,0 +1,129 @@
+﻿#include "ComputePool.h"
+
+#include <algorithm>
+
+namespace Se
+{
+auto ComputeJob::Done() const -> bool
+{
+	return _state == nullptr || _state->Remaining == 0;
+}
+
+void ComputeJob::Wait() const
+{
+	if (_state == nullptr)
+	{
+		return;
+	}
+	std::unique_lock lock(_state->Mutex);
+	_state->Finished.wait(lock, [this] { return _state->Remaining == 0; });
+}
+
+ComputePool::ComputePool(size_t threadCount)
+{
+	Start(threadCount);
+}
+
+ComputePool::~ComputePool()
+{
+	Stop();
+}
+
+auto ComputePool::Instance() -> ComputePool&
+{
+	static ComputePool pool;
+	return pool;
+}
+
+auto ComputePool::DefaultThreadCount() -> size_t
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+auto ComputePool::ThreadCount() const -> size_t
+{
+	return _threads.size();
+}
+
+void ComputePool::SetThreadCount(size_t threadCount)
+{
+	if (threadCount == _threads.size())
+	{
+		return;
+	}
+	Stop();
+	Start(threadCount);
+}
+
+auto ComputePool::Dispatch(size_t taskCount, std::function<void(size_t)> task) -> ComputeJob
+{
+	ComputeJob job;
+	job._state = std::make_shared<ComputeJob::State>();
+	job._state->Remaining = taskCount;
+
+	auto shared = std::make_shared<std::function<void(size_t)>>(std::move(task));
+	{
+		std::scoped_lock lock(_mutex);
+		for (size_t i = 0; i < taskCount; i++)
+		{
+			_tasks.emplace_back([state = job._state, shared, i]
+			{
+				(*shared)(i);
+				if (--state->Remaining == 0)
+				{
+					// Lock so the notification cannot slip in between a waiter's check and its sleep
+					std::scoped_lock finishedLock(state->Mutex);
+					state->Finished.notify_all();
+				}
+			});
+		}
+	}
+	_taskAvailable.notify_all();
+
+	return job;
+}
+
+void ComputePool::Start(size_t threadCount)
+{
+	_stopping = false;
+	for (size_t i = 0; i < std::max<size_t>(threadCount, 1); i++)
+	{
+		_threads.emplace_back(&ComputePool::Run, this);
+	}
+}
+
+void ComputePool::Stop()
+{
+	{
+		std::scoped_lock lock(_mutex);
+		_stopping = true;
+	}
+	_taskAvailable.notify_all();
+	for (auto& thread : _threads)
+	{
+		thread.join();
+	}
+	_threads.clear();
+}
+
+void ComputePool::Run()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock lock(_mutex);
+			_taskAvailable.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+			// Queued tasks are always finished, someone may be waiting on them
+			if (_tasks.empty())
+			{
+				return;
+			}
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+		task();
+	}
+}
+}
@@ -0,0 +1,67 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Se
+{
+class ComputeJob
+{
+	friend class ComputePool;
+
+public:
+	ComputeJob() = default;
+
+	auto Done() const -> bool;
+	void Wait() const;
+
+private:
+	struct State
+	{
+		std::atomic<size_t> Remaining = 0;
+		mutable std::mutex Mutex;
+		mutable std::condition_variable Finished;
+	};
+
+	std::shared_ptr<State> _state;
+};
+
+// One set of compute threads for the whole process, shared by every CPU host.
+// Sized from the hardware concurrency unless overridden with SetThreadCount.
+class ComputePool
+{
+public:
+	explicit ComputePool(size_t threadCount = DefaultThreadCount());
+	~ComputePool();
+
+	ComputePool(const ComputePool&) = delete;
+	auto operator=(const ComputePool&) -> ComputePool& = delete;
+
+	static auto Instance() -> ComputePool&;
+	static auto DefaultThreadCount() -> size_t;
+
+	auto ThreadCount() const -> size_t;
+	void SetThreadCount(size_t threadCount);
+
+	// Runs task(0) ... task(taskCount - 1) on the pool
+	auto Dispatch(size_t taskCount, std::function<void(size_t)> task) -> ComputeJob;
+
+private:
+	void Start(size_t threadCount);
+	void Stop();
+	void Run();
+
+private:
+	std::vector<std::thread> _threads;
+	std::deque<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _taskAvailable;
+	bool _stopping = false;
+};
+}
@@ -0,0 +1,140 @@
+﻿#include "DoubleDouble.h"
+
+#include <cmath>
+
+namespace Se
+{
+namespace
+{
+// hi + lo == a + b exactly
+auto TwoSum(double a, double b) -> DoubleDouble
+{
+	DoubleDouble result;
+	result.Hi = a + b;
+	const double b1 = result.Hi - a;
+	result.Lo = (a - (result.Hi - b1)) + (b - b1);
+	return result;
+}
+
+// Same, for |a| >= |b|
+auto QuickTwoSum(double a, double b) -> DoubleDouble
+{
+	DoubleDouble result;
+	result.Hi = a + b;
+	result.Lo = b - (result.Hi - a);
+	return result;
+}
+
+// hi + lo == a * b exactly
+auto TwoProduct(double a, double b) -> DoubleDouble
+{
+	DoubleDouble result;
+	result.Hi = a * b;
+	result.Lo = std::fma(a, b, -result.Hi);
+	return result;
+}
+}
+
+DoubleDouble::DoubleDouble(double value) :
+	Hi(value)
+{
+}
+
+DoubleDouble::DoubleDouble(double hi, double lo)
+{
+	*this = TwoSum(hi, lo);
+}
+
+auto DoubleDouble::ToDouble() const -> double
+{
+	return Hi + Lo;
+}
+
+auto DoubleDouble::operator-() const -> DoubleDouble
+{
+	DoubleDouble result;
+	result.Hi = -Hi;
+	result.Lo = -Lo;
+	return result;
+}
+
+auto DoubleDouble::operator+(const DoubleDouble& other) const -> DoubleDouble
+{
+	// Adds the low parts separately so cancelling high parts keep all their digits
+	const DoubleDouble high = TwoSum(Hi, other.Hi);
+	const DoubleDouble low = TwoSum(Lo, other.Lo);
+	const DoubleDouble sum = QuickTwoSum(high.Hi, high.Lo + low.Hi);
+	return QuickTwoSum(sum.Hi, sum.Lo + low.Lo);
+}
+
+auto DoubleDouble::operator-(const DoubleDouble& other) const -> DoubleDouble
+{
+	return *this + -other;
+}
+
+auto DoubleDouble::operator*(const DoubleDouble& other) const -> DoubleDouble
+{
+	const DoubleDouble product = TwoProduct(Hi, other.Hi);
+	return QuickTwoSum(product.Hi, product.Lo + (Hi * other.Lo + Lo * other.Hi));
+}
+
+auto DoubleDouble::operator/(double divisor) const -> DoubleDouble
+{
+	// One long division step on the remainder
+	const double first = Hi / divisor;
+	const DoubleDouble remainder = *this - TwoProduct(first, divisor);
+	return QuickTwoSum(first, remainder.Hi / divisor);
+}
+
+auto DoubleDouble::operator==(const DoubleDouble& other) const -> bool
+{
+	return Hi == other.Hi && Lo == other.Lo;
+}
+
+auto DoubleDouble::operator!=(const DoubleDouble& other) const -> bool
+{
+	return !(*this == other);
+}
+
+PrecisePosition::PrecisePosition(const Position& position) :
+	x(position.x),
+	y(position.y)
+{
+}
+
+PrecisePosition::PrecisePosition(const DoubleDouble& x, const DoubleDouble& y) :
+	x(x),
+	y(y)
+{
+}
+
+auto PrecisePosition::ToPosition() const -> Position
+{
+	return {x.ToDouble(), y.ToDouble()};
+}
+
+auto PrecisePosition::Low() const -> Position
+{
+	return {x.Lo, y.Lo};
+}
+
+auto PrecisePosition::operator+(const PrecisePosition& other) const -> PrecisePosition
+{
+	return {x + other.x, y + other.y};
+}
+
+auto PrecisePosition::operator-(const PrecisePosition& other) const -> PrecisePosition
+{
+	return {x - other.x, y - other.y};
+}
+
+auto PrecisePosition::operator==(const PrecisePosition& other) const -> bool
+{
+	return x == other.x && y == other.y;
+}
+
+auto PrecisePosition::operator!=(const PrecisePosition& other) const -> bool
+{
+	return !(*this == other);
+}
+}
@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "Common.h"
+
+namespace Se
+{
+// An unevaluated sum Hi + Lo with |Lo| at most half an ulp of Hi, about 32 significant digits.
+// For view coordinates deeper than Position can hold, the kernels have their own SIMD version.
+struct DoubleDouble
+{
+	double Hi = 0.0;
+	double Lo = 0.0;
+
+	DoubleDouble() = default;
+	DoubleDouble(double value);
+	// Normalises, hi and lo may overlap
+	DoubleDouble(double hi, double lo);
+
+	auto ToDouble() const -> double;
+
+	auto operator-() const -> DoubleDouble;
+	auto operator+(const DoubleDouble& other) const -> DoubleDouble;
+	auto operator-(const DoubleDouble& other) const -> DoubleDouble;
+	auto operator*(const DoubleDouble& other) const -> DoubleDouble;
+	auto operator/(double divisor) const -> DoubleDouble;
+	auto operator==(const DoubleDouble& other) const -> bool;
+	auto operator!=(const DoubleDouble& other) const -> bool;
+};
+
+// Position to double-double precision
+struct PrecisePosition
+{
+	DoubleDouble x, y;
+
+	PrecisePosition() = default;
+	PrecisePosition(const Position& position);
+	PrecisePosition(const DoubleDouble& x, const DoubleDouble& y);
+
+	// Rounded to the nearest Position
+	auto ToPosition() const -> Position;
+	// Offsets to the high parts, what Position loses of the coordinates
+	auto Low() const -> Position;
+
+	auto operator+(const PrecisePosition& other) const -> PrecisePosition;
+	auto operator-(const PrecisePosition& other) const -> PrecisePosition;
+	auto operator==(const PrecisePosition& other) const -> bool;
+	auto operator!=(const PrecisePosition& other) const -> bool;
+};
+}
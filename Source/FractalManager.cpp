@@ -2,12 +2,20 @@
 
 #include <Saffron.h>
 
+#include "ComputePool.h"
+#include "ComputeHosts/PerturbationHost.h"
+#include "ComputeHosts/TileStore.h"
+#include "Kernels/Kernels.h"
+
 namespace Se
 {
 FractalManager::FractalManager(const sf::Vector2f& renderSize) :
 	_lastViewport(VecUtils::Null<double>(), VecUtils::Null<double>()),
-	_paletteComboBoxNames({"Fiery", "Fiery Alt", "UV", "Greyscale", "Rainbow"}),
-	_precisionComboBoxNames({"32-bit", "64-bit"}),
+	_paletteComboBoxNames({
+		PaletteName(PaletteType::Fiery), PaletteName(PaletteType::FieryAlt), PaletteName(PaletteType::UV),
+		PaletteName(PaletteType::GreyScale), PaletteName(PaletteType::Rainbow)
+	}),
+	_precisionComboBoxNames({"32-bit", "64-bit", "Double-double", "Automatic"}),
 	_fractalSetGenerationTypeNames({"Automatic", "Delayed", "Manual"})
 {
 	_fractalSets.emplace_back(std::make_unique<Mandelbrot>(renderSize));
@@ -16,6 +24,7 @@ FractalManager::FractalManager(const sf::Vector2f& renderSize) :
 	_fractalSets.emplace_back(std::make_unique<Polynomial>(renderSize));
 
 	_activeFractalSetType = FractalSetType::Mandelbrot;
+	ActiveFractalSet().SetActive(true);
 
 	for (const auto& fractalSet : _fractalSets)
 	{
@@ -24,23 +33,31 @@ FractalManager::FractalManager(const sf::Vector2f& renderSize) :
 
 	_hostInt = static_cast<int>(ActiveFractalSet().ActiveHostType());
 
-	constexpr auto factor = 200.0;
-	_cameraZoom *= factor;
-	_cameraZoomTransform.Scale(factor, factor);
+	_zoomExponent = std::log2(DefaultZoom);
 	UpdateTransform();
 }
 
 
 void FractalManager::OnUpdate(Scene& scene)
 {
+	const auto cameraPosition = CameraPosition();
 	scene.Camera().SetTransform(static_cast<sf::Transform>(_cameraTransform));
-	scene.Camera().SetZoom(_cameraZoom.x);
-	scene.Camera().SetCenter(sf::Vector2f(_cameraPosition.x, _cameraPosition.y));
+	scene.Camera().SetZoom(std::exp2(std::min(_zoomExponent, MaxTransformZoomExponent)));
+	scene.Camera().SetCenter(sf::Vector2f(cameraPosition.x, cameraPosition.y));
 
 	if (!_manualSetIterations)
 	{
-		const auto iterations = std::min(2000ull, static_cast<ulong>(std::pow(_cameraZoom.x, 0.5)) + 20);
-		SetComputeIterationCount(iterations);
+		const ulong cap = ActiveFractalSet().ActiveHostType() == HostType::CpuPerturbation
+			                  ? DeepAutoIterationCap
+			                  : AutoIterationCap;
+		const auto iterations = static_cast<ulong>(std::min(static_cast<double>(cap),
+		                                                   std::exp2(_zoomExponent / 2.0) + 20.0));
+		// Only request when the count changes, progressive passes would otherwise restart every frame
+		if (iterations != _autoComputeIterations)
+		{
+			_autoComputeIterations = iterations;
+			SetComputeIterationCount(iterations);
+		}
 	}
 
 	bool autoMove = false;
@@ -50,14 +67,12 @@ void FractalManager::OnUpdate(Scene& scene)
 		const auto delta = (std::sin(_zoomTransitionTimer / _zoomTransitionDuration * PI<double> - PI<double> / 2.0) +
 			1.0) / 2.0;
 
-		const auto zoom = _startZoom + delta * (_desiredZoom - _startZoom);
-		_cameraZoom = Position{zoom, zoom};
-		_cameraZoomTransform = Transform<double>().Scale(_cameraZoom);
+		_zoomExponent = _startZoom + delta * (_desiredZoom - _startZoom);
 		_zoomTransitionTimer += Global::Clock::FrameTime().asSeconds();
 
 		if (_zoomTransitionTimer > _zoomTransitionDuration)
 		{
-			_cameraZoom = Position{_desiredZoom, _desiredZoom};
+			_zoomExponent = _desiredZoom;
 		}
 	}
 	else if (_positionTransitionTimer <= _positionTransitionDuration)
@@ -66,16 +81,15 @@ void FractalManager::OnUpdate(Scene& scene)
 		const auto delta = (std::sin(
 			_positionTransitionTimer / _positionTransitionDuration * PI<double> - PI<double> / 2.0) + 1.0) / 2.0;
 
-		_cameraPosition = _startPos + delta * (_desiredCameraPos - _startPos);
-		_cameraPositionTransform = Transform<double>().Translate(_cameraPosition);
+		SetCameraPosition(_startPos + delta * (_desiredCameraPos - _startPos));
 		_positionTransitionTimer += Global::Clock::FrameTime().asSeconds();
 
 		if (_positionTransitionTimer > _positionTransitionDuration)
 		{
-			_cameraPosition = _desiredCameraPos;
+			SetCameraPosition(_desiredCameraPos);
 			_zoomTransitionTimer = 0.0;
 			_desiredZoom = _desiredZoomLater;
-			_startZoom = _cameraZoom.x;
+			_startZoom = _zoomExponent;
 		}
 	}
 
@@ -91,7 +105,7 @@ void FractalManager::OnUpdate(Scene& scene)
 
 	if (scene.ViewportPane().ViewportSize().x < 200 || scene.ViewportPane().ViewportSize().y < 200) return;
 
-	const SimBox sbViewport = GenerateSimBox(scene.Camera());
+	const SimBox sbViewport = GenerateSimBox();
 	if (_lastViewport != sbViewport)
 	{
 		_lastViewport = sbViewport;
@@ -107,6 +121,13 @@ void FractalManager::OnUpdate(Scene& scene)
 		}
 		ActiveFractalSet().RequestImageRendering();
 	}
+
+	// Tiles under the cursor go first while it is over the image
+	const auto mouse = scene.ViewportPane().MousePosition();
+	const auto viewportSize = scene.ViewportPane().ViewportSize();
+	const bool hovered = mouse.x >= 0.0f && mouse.y >= 0.0f && mouse.x < viewportSize.x && mouse.y < viewportSize.y;
+	ActiveFractalSet().ActiveHost().SetFocus(_cursorFocus && hovered ? std::optional(mouse) : std::nullopt);
+
 	ActiveFractalSet().OnUpdate(scene);
 }
 
@@ -189,6 +210,10 @@ void FractalManager::OnGuiRender()
 	case FractalSetGenerationType::DelayedGeneration: break;
 	}
 
+	const auto& activeSet = ActiveFractalSet();
+	ImGui::Text("%zu requests, %zu computed", activeSet.GenerationRequests(), activeSet.Generations());
+	ImGui::Text("%zu merged, %zu dropped", activeSet.MergedRequests(), activeSet.DroppedRequests());
+
 	Gui::EndPropertyGrid();
 
 	ImGui::Separator();
@@ -218,12 +243,17 @@ void FractalManager::OnGuiRender()
 		{
 			SetComputeIterationCount(_computeIterations);
 		}
+		_autoComputeIterations = 0;
 	}
 	ImGui::PushItemWidth(-1);
 	if (_manualSetIterations)
 	{
 		ImGui::SameLine();
-		if (ImGui::SliderInt("##SliderIterations", &_computeIterations, 10, 2000, "%d", ImGuiSliderFlags_Logarithmic))
+		const int maxIterations = static_cast<int>(ActiveFractalSet().ActiveHostType() == HostType::CpuPerturbation
+			                                           ? DeepAutoIterationCap
+			                                           : AutoIterationCap);
+		if (ImGui::SliderInt("##SliderIterations", &_computeIterations, 10, maxIterations, "%d",
+		                     ImGuiSliderFlags_Logarithmic))
 		{
 			SetComputeIterationCount(_computeIterations);
 		}
@@ -233,31 +263,27 @@ void FractalManager::OnGuiRender()
 	ImGui::Text("Zoom");
 	ImGui::NextColumn();
 	ImGui::PushItemWidth(-1);
-	_zoom = _cameraZoom.x;
-	if (ImGui::DragScalar("##Zoom", ImGuiDataType_U64, &_zoom, 7))
-	{
-		_cameraZoom = Position(_zoom, _zoom);
-		_cameraPositionTransform = Transform<double>().Scale(_cameraZoom);
-	}
+	ImGui::DragScalar("##Zoom", ImGuiDataType_Double, &_zoomExponent, 0.02f, nullptr, nullptr, "2^%.2f");
 
 	ImGui::NextColumn();
 
+	// Only the change is added to the centre, so the digits below double's resolution stay
+	auto cameraPosition = CameraPosition();
+	const auto positionSpeed = 10.0 * PixelSpacing().ToDouble();
 	ImGui::Text("R");
 	ImGui::SameLine();
 	ImGui::PushItemWidth(-1);
-	if (ImGui::DragScalar("##PosR", ImGuiDataType_Double, &_cameraPosition.x,
-	                      1.0 / (static_cast<double>(_zoom) / 10.0)))
+	if (ImGui::DragScalar("##PosR", ImGuiDataType_Double, &cameraPosition.x, positionSpeed))
 	{
-		_cameraPositionTransform = Transform<double>().Scale(_cameraPosition);
+		_cameraX = _cameraX + BigReal(cameraPosition.x - _cameraX.ToDouble(), CameraLimbs());
 	}
 	ImGui::NextColumn();
 	ImGui::Text("I");
 	ImGui::SameLine();
 	ImGui::PushItemWidth(-1);
-	if (ImGui::DragScalar("##PosI", ImGuiDataType_Double, &_cameraPosition.y,
-	                      1.0 / (static_cast<double>(_zoom) / 10.0)))
+	if (ImGui::DragScalar("##PosI", ImGuiDataType_Double, &cameraPosition.y, positionSpeed))
 	{
-		_cameraPositionTransform = Transform<double>().Scale(_cameraPosition);
+		_cameraY = _cameraY + BigReal(cameraPosition.y - _cameraY.ToDouble(), CameraLimbs());
 	}
 	ImGui::NextColumn();
 
@@ -265,6 +291,320 @@ void FractalManager::OnGuiRender()
 
 	ImGui::Separator();
 
+	const auto activeType = ActiveFractalSet().ActiveHostType();
+	if (activeType == HostType::Cpu || activeType == HostType::CpuPerturbation)
+	{
+		auto& cpuHost = ActiveFractalSet().ActiveHost().As<CpuHost>();
+
+		Gui::BeginPropertyGrid("Workers");
+
+		ImGui::Text("Threads");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		int threads = static_cast<int>(ComputePool::Instance().ThreadCount());
+		if (ImGui::SliderInt("##Threads", &threads, 1, 2 * static_cast<int>(ComputePool::DefaultThreadCount())))
+		{
+			// Frames of any set may still be running on the pool
+			for (const auto& fractalSet : _fractalSets)
+			{
+				fractalSet->CancelComputation();
+			}
+			ComputePool::Instance().SetThreadCount(threads);
+			cpuHost.Invalidate();
+			MarkForImageComputation();
+			MarkForImageRendering();
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("Instruction Set");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		std::vector<Kernels::Isa> isas;
+		std::vector<const char*> isaNames;
+		int activeIsa = 0;
+		for (int i = 0; i < static_cast<int>(Kernels::Isa::Count); i++)
+		{
+			const auto isa = static_cast<Kernels::Isa>(i);
+			if (Kernels::Supported(isa))
+			{
+				if (isa == Kernels::Active().Isa)
+				{
+					activeIsa = static_cast<int>(isas.size());
+				}
+				isas.push_back(isa);
+				isaNames.push_back(Kernels::IsaName(isa));
+			}
+		}
+		if (ImGui::Combo("##InstructionSet", &activeIsa, isaNames.data(), static_cast<int>(isaNames.size())))
+		{
+			Kernels::SetActive(isas[activeIsa]);
+			cpuHost.Invalidate();
+			MarkForImageComputation();
+			MarkForImageRendering();
+		}
+		ImGui::NextColumn();
+
+		if (activeType == HostType::Cpu)
+		{
+			ImGui::Text("Precision");
+			ImGui::NextColumn();
+			ImGui::PushItemWidth(-1);
+			if (ImGui::Combo("##Precision", &_activePrecisionInt, _precisionComboBoxNames.data(),
+			                 static_cast<int>(_precisionComboBoxNames.size())))
+			{
+				SetPrecision(static_cast<FractalGenerationPrecision>(_activePrecisionInt));
+				MarkForImageComputation();
+				MarkForImageRendering();
+			}
+			ImGui::NextColumn();
+		}
+
+		ImGui::Text("Tile Size");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		int tileSize = cpuHost.TileSize();
+		if (ImGui::SliderInt("##TileSize", &tileSize, 8, 256))
+		{
+			cpuHost.SetTileSize(tileSize);
+			cpuHost.Invalidate();
+			MarkForImageComputation();
+			MarkForImageRendering();
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("Progressive");
+		ImGui::NextColumn();
+		bool progressive = cpuHost.Progressive();
+		if (ImGui::Checkbox("##Progressive", &progressive))
+		{
+			cpuHost.SetProgressive(progressive);
+			cpuHost.Invalidate();
+			MarkForImageComputation();
+			MarkForImageRendering();
+		}
+		ImGui::NextColumn();
+
+		if (cpuHost.SupportsSubdivision())
+		{
+			ImGui::Text("Subdivision");
+			ImGui::NextColumn();
+			bool subdivision = cpuHost.Subdivision();
+			if (ImGui::Checkbox("##Subdivision", &subdivision))
+			{
+				cpuHost.SetSubdivision(subdivision);
+				cpuHost.Invalidate();
+				MarkForImageComputation();
+				MarkForImageRendering();
+			}
+			if (subdivision)
+			{
+				ImGui::SameLine();
+				bool validate = cpuHost.ValidateSubdivision();
+				if (ImGui::Checkbox("Validate", &validate))
+				{
+					cpuHost.SetValidateSubdivision(validate);
+					cpuHost.Invalidate();
+					MarkForImageComputation();
+				}
+				ImGui::Text("%zu filled", cpuHost.FilledPixels());
+				if (validate)
+				{
+					ImGui::SameLine();
+					ImGui::Text("%zu mismatches", cpuHost.SubdivisionMismatches());
+				}
+			}
+			ImGui::NextColumn();
+		}
+
+		ImGui::Text("Periodicity");
+		ImGui::NextColumn();
+		bool periodicity = cpuHost.Periodicity();
+		if (ImGui::Checkbox("##Periodicity", &periodicity))
+		{
+			cpuHost.SetPeriodicity(periodicity);
+			cpuHost.Invalidate();
+			MarkForImageComputation();
+			MarkForImageRendering();
+		}
+		if (periodicity)
+		{
+			ImGui::SameLine();
+			ImGui::PushItemWidth(-1);
+			double tolerance = cpuHost.PeriodicityTolerance();
+			const double minTolerance = 1e-16, maxTolerance = 1e-4;
+			if (ImGui::SliderScalar("##PeriodicityTolerance", ImGuiDataType_Double, &tolerance, &minTolerance,
+			                        &maxTolerance, "%.0e", ImGuiSliderFlags_Logarithmic))
+			{
+				cpuHost.SetPeriodicityTolerance(tolerance);
+				cpuHost.Invalidate();
+				MarkForImageComputation();
+				MarkForImageRendering();
+			}
+			ImGui::Text("%zu iterations saved", cpuHost.SavedIterations());
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("Streaming");
+		ImGui::NextColumn();
+		bool streaming = cpuHost.Streaming();
+		if (ImGui::Checkbox("##Streaming", &streaming))
+		{
+			cpuHost.SetStreaming(streaming);
+			cpuHost.Invalidate();
+			MarkForImageComputation();
+		}
+		ImGui::SameLine();
+		ImGui::Text("%.0f%% lanes busy", cpuHost.LaneUtilisation() * 100.0);
+		ImGui::SameLine();
+		if (ImGui::Button("Benchmark"))
+		{
+			cpuHost.RunLaneBenchmark();
+		}
+		if (const auto& benchmark = cpuHost.LastLaneBenchmark())
+		{
+			ImGui::Text("Grouped %.1f ms, %.0f%%", benchmark->GroupedSeconds * 1000.0,
+			            benchmark->GroupedUtilisation * 100.0);
+			ImGui::Text("Streaming %.1f ms, %.0f%%", benchmark->StreamingSeconds * 1000.0,
+			            benchmark->StreamingUtilisation * 100.0);
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("Reuse Tolerance");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		int tolerance = cpuHost.ReprojectionTolerance();
+		if (ImGui::SliderInt("##ReuseTolerance", &tolerance, -1, 32, tolerance < 0 ? "Off" : "%d"))
+		{
+			cpuHost.SetReprojectionTolerance(tolerance);
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("Frame Budget");
+		ImGui::NextColumn();
+		ImGui::PushItemWidth(-1);
+		float budget = static_cast<float>(cpuHost.FrameBudget());
+		if (ImGui::SliderFloat("##FrameBudget", &budget, 0.0f, 50.0f, budget > 0.0f ? "%.0f ms" : "Off"))
+		{
+			cpuHost.SetFrameBudget(budget);
+		}
+		ImGui::Checkbox("Cursor First", &_cursorFocus);
+		ImGui::SameLine();
+		ImGui::Text("%zu tiles per frame, %zu carried", cpuHost.FinishedTiles(), cpuHost.CarriedTiles());
+		ImGui::NextColumn();
+
+		ImGui::Text("Tile Cache");
+		ImGui::NextColumn();
+		auto& tileCache = TileCache::Instance();
+		ImGui::PushItemWidth(-1);
+		int cacheBudget = static_cast<int>(tileCache.Budget() >> 20);
+		if (ImGui::SliderInt("##TileCacheBudget", &cacheBudget, 0, 4096, "%d MB"))
+		{
+			tileCache.SetBudget(static_cast<size_t>(cacheBudget) << 20);
+		}
+		ImGui::Text("%zu tiles, %.0f MB", tileCache.TileCount(), static_cast<double>(tileCache.Bytes()) / (1 << 20));
+		ImGui::SameLine();
+		if (ImGui::Button("Clear"))
+		{
+			tileCache.Clear();
+		}
+		ImGui::Text("%zu hits, %zu from disk, %zu misses, %zu evicted", tileCache.Hits(), tileCache.StoreHits(),
+		            tileCache.Misses(), tileCache.Evictions());
+		if (const auto* store = tileCache.DiskStore())
+		{
+			ImGui::Text("%zu tiles on disk, %.1f MB, %.1f MB current", store->TileCount(),
+			            static_cast<double>(store->Bytes()) / (1 << 20), static_cast<double>(store->LiveBytes()) / (1 << 20));
+		}
+		else
+		{
+			ImGui::Text("Disk store unavailable");
+		}
+		ImGui::Text("%zu pixels of this view cached", cpuHost.CachedPixels());
+		ImGui::NextColumn();
+
+		ImGui::Text("Frame");
+		ImGui::NextColumn();
+		ImGui::Text("%s", Kernels::PrecisionName(cpuHost.ActivePrecision()));
+		ImGui::SameLine();
+		if (cpuHost.Panned())
+		{
+			ImGui::Text("%.1f ms, %zu tiles, panned", cpuHost.FrameSeconds() * 1000.0, cpuHost.TileCount());
+		}
+		else if (cpuHost.Reprojected())
+		{
+			ImGui::Text("%.1f ms, %zu tiles, %zu pending", cpuHost.FrameSeconds() * 1000.0, cpuHost.TileCount(),
+			            cpuHost.PendingTiles());
+		}
+		else if (cpuHost.Progressive())
+		{
+			ImGui::Text("%.1f ms, %zu tiles, pass %d/%zu", cpuHost.FrameSeconds() * 1000.0, cpuHost.TileCount(),
+			            cpuHost.ProgressivePass() + 1, CpuHost::ProgressiveSteps.size());
+		}
+		else
+		{
+			ImGui::Text("%.1f ms, %zu tiles", cpuHost.FrameSeconds() * 1000.0, cpuHost.TileCount());
+		}
+		ImGui::NextColumn();
+
+		ImGui::Text("Tile Precision");
+		ImGui::NextColumn();
+		std::string precisionTiles;
+		for (size_t i = 0; i < static_cast<size_t>(Kernels::Precision::Count); i++)
+		{
+			const auto precision = static_cast<Kernels::Precision>(i);
+			if (const auto tiles = cpuHost.PrecisionTiles(precision); tiles > 0)
+			{
+				precisionTiles += (precisionTiles.empty() ? "" : ", ") + std::to_string(tiles) + " " +
+					Kernels::PrecisionName(precision);
+			}
+		}
+		ImGui::Text("%s", precisionTiles.c_str());
+		ImGui::NextColumn();
+
+		if (activeType == HostType::CpuPerturbation)
+		{
+			auto& perturbationHost = cpuHost.As<PerturbationHost>();
+			ImGui::Text("Reference");
+			ImGui::NextColumn();
+			ImGui::Text("%zu iterations, %d bits, %.1f ms", perturbationHost.OrbitLength(),
+			            perturbationHost.OrbitBits(), perturbationHost.OrbitSeconds() * 1000.0);
+			ImGui::Text("%d used, %zu glitched, %zu unresolved", perturbationHost.ReferenceCount(),
+			            perturbationHost.GlitchedPixels(), perturbationHost.UnresolvedPixels());
+			ImGui::Text("%zu tiles computed again", perturbationHost.GlitchTiles());
+			ImGui::Text("%zu iterations on extended offsets", perturbationHost.ExtendedIterations());
+			ImGui::NextColumn();
+
+			ImGui::Text("Approximation");
+			ImGui::NextColumn();
+			bool approximation = perturbationHost.Approximation();
+			if (ImGui::Checkbox("##Approximation", &approximation))
+			{
+				perturbationHost.SetApproximation(approximation);
+				cpuHost.Invalidate();
+				MarkForImageComputation();
+				MarkForImageRendering();
+			}
+			ImGui::SameLine();
+			ImGui::Text("%zu iterations skipped", perturbationHost.ApproximatedIterations());
+			ImGui::NextColumn();
+		}
+
+		const auto& frameStats = cpuHost.FrameStats();
+		for (size_t i = 0; i < frameStats.size(); i++)
+		{
+			const auto& stats = frameStats[i];
+			const auto overlay = std::to_string(stats.Tiles) + " tiles, " + std::to_string(stats.StolenTiles) +
+				" stolen";
+			ImGui::Text("Worker %zu", i);
+			ImGui::NextColumn();
+			ImGui::ProgressBar(static_cast<float>(cpuHost.Utilisation(i)), ImVec2(-1.0f, 0.0f), overlay.c_str());
+			ImGui::NextColumn();
+		}
+
+		Gui::EndPropertyGrid();
+
+		ImGui::Separator();
+	}
+
 	bool anyAdd = true;
 
 	// Draw options
@@ -330,7 +670,12 @@ void FractalManager::OnGuiRender()
 	{
 	case FractalSetType::Mandelbrot:
 	{
-		anyAdd = false;
+		Gui::BeginPropertyGrid();
+		ImGui::Text("Skipped Pixels");
+		ImGui::NextColumn();
+		ImGui::Text("%zu", ActiveFractalSet().As<Mandelbrot>().SkippedPixels());
+		ImGui::NextColumn();
+		Gui::EndPropertyGrid();
 		break;
 	}
 	case FractalSetType::Julia:
@@ -451,12 +796,12 @@ void FractalManager::OnGuiRender()
 		{
 			_positionTransitionTimer = 0.0;
 			_desiredCameraPos = position;
-			_startPos = _cameraPosition;
+			_startPos = CameraPosition();
 
 			_zoomTransitionTimer = 0.0;
-			_desiredZoom = 200.0;
-			_desiredZoomLater = zoom;
-			_startZoom = _cameraZoom.x;
+			_desiredZoom = std::log2(DefaultZoom);
+			_desiredZoomLater = std::log2(zoom);
+			_startZoom = _zoomExponent;
 		}
 		ImGui::NextColumn();
 	}
@@ -484,9 +829,11 @@ void FractalManager::Resize(const sf::Vector2f& size)
 
 void FractalManager::SetFractalSet(FractalSetType type)
 {
+	ActiveFractalSet().SetActive(false);
 	_activeFractalSetType = type;
 
 	auto& activeFractalSet = ActiveFractalSet();
+	activeFractalSet.SetActive(true);
 	activeFractalSet.RequestImageComputation();
 	activeFractalSet.RequestImageRendering();
 
@@ -498,15 +845,16 @@ void FractalManager::SetFractalSet(FractalSetType type)
 
 void FractalManager::SetComputeIterationCount(size_t iterations)
 {
+	// The others pick the count up when they are next computed
 	for (const auto& fractalSet : _fractalSets)
 	{
 		fractalSet->SetComputeIterationCount(iterations);
-		if (ActiveGenerationType() != FractalSetGenerationType::ManualGeneration)
-		{
-			fractalSet->RequestImageComputation();
-		}
-		fractalSet->RequestImageRendering();
 	}
+	if (ActiveGenerationType() != FractalSetGenerationType::ManualGeneration)
+	{
+		ActiveFractalSet().RequestImageComputation();
+	}
+	ActiveFractalSet().RequestImageRendering();
 }
 
 void FractalManager::SetHost(HostType computeHost)
@@ -606,10 +954,36 @@ void FractalManager::SetAxisState(bool state)
 
 void FractalManager::SetPrecision(FractalGenerationPrecision precision)
 {
-	// It is POSSIBLE to use 32-bit floating point precision.
-	// But it was removed from Gui, since it cluttered more than
-	// it provided
 	_precision = precision;
+
+	auto mode = PrecisionMode::Automatic;
+	switch (precision)
+	{
+	case FractalGenerationPrecision::Bit32:
+	{
+		mode = PrecisionMode::Float;
+		break;
+	}
+	case FractalGenerationPrecision::Bit64:
+	{
+		mode = PrecisionMode::Double;
+		break;
+	}
+	case FractalGenerationPrecision::DoubleDouble:
+	{
+		mode = PrecisionMode::DoubleDouble;
+		break;
+	}
+	case FractalGenerationPrecision::Automatic: break;
+	}
+	for (const auto& fractalSet : _fractalSets)
+	{
+		const auto& hosts = fractalSet->Hosts();
+		if (const auto it = hosts.find(HostType::Cpu); it != hosts.end())
+		{
+			it->second->As<CpuHost>().SetPrecision(mode);
+		}
+	}
 }
 
 void FractalManager::PauseJuliaAnimation()
@@ -639,69 +1013,88 @@ void FractalManager::UpdateHighPrecCamera()
 		auto delta = VecUtils::ConvertTo<Position>(Mouse::Swipe());
 		if (VecUtils::LengthSq(delta) > 0.0)
 		{
-			delta = _cameraZoomTransform.Inverse().TransformPoint(delta);
-			delta *= -1.0;
-
-			const auto center = _cameraPosition + delta;
-			_cameraPosition = center;
-			_cameraPositionTransform = Transform<double>().Translate(_cameraPosition);
-			UpdateTransform();
+			MoveCamera(-delta);
 		}
 	}
 
 	const auto factor = static_cast<double>(Mouse::VerticalScroll()) / 100.0 + 1.0;
-	_cameraZoom *= factor;
-	_cameraZoomTransform.Scale(factor, factor);
-	UpdateTransform();
+	if (factor > 0.0)
+	{
+		_zoomExponent += std::log2(factor);
+	}
 
 	if (Keyboard::IsPressed(sf::Keyboard::R))
 	{
-		_cameraPosition = {0.0, 0.0};
-		_cameraPositionTransform = Transform<double>().Translate(_cameraPosition);
-
-		_cameraZoom = {1.0, 1.0};
-		_cameraZoomTransform = Transform<double>::Identity;
-
-		const auto resetFactor = 200.0;
-		_cameraZoom *= resetFactor;
-		_cameraZoomTransform.Scale(resetFactor, resetFactor);
-		UpdateTransform();
+		SetCameraPosition({0.0, 0.0});
+		_zoomExponent = std::log2(DefaultZoom);
 	}
+	UpdateTransform();
 }
 
 void FractalManager::UpdateTransform()
 {
+	const auto zoom = std::exp2(std::min(_zoomExponent, MaxTransformZoomExponent));
 	_cameraTransform = Transform<double>::Identity;
 	_cameraTransform.Translate(_viewportSize / 2.0);
-	_cameraTransform.Scale(_cameraZoom);
-	_cameraTransform.Translate(-_cameraPosition);
+	_cameraTransform.Scale(zoom, zoom);
+	_cameraTransform.Translate(-CameraPosition());
+}
+
+void FractalManager::MoveCamera(const Position& pixels)
+{
+	const auto spacing = PixelSpacing();
+	_cameraX = _cameraX + BigReal(ExtendedReal(pixels.x) * spacing, CameraLimbs());
+	_cameraY = _cameraY + BigReal(ExtendedReal(pixels.y) * spacing, CameraLimbs());
+}
+
+void FractalManager::SetCameraPosition(const Position& position)
+{
+	_cameraX = BigReal(position.x, CameraLimbs());
+	_cameraY = BigReal(position.y, CameraLimbs());
 }
 
-auto FractalManager::GenerateSimBox(const Camera& camera) const -> SimBox
+auto FractalManager::CameraPosition() const -> Position
+{
+	return {_cameraX.ToDouble(), _cameraY.ToDouble()};
+}
+
+auto FractalManager::CameraLimbs() const -> int
+{
+	const auto pixelBits = static_cast<int>(std::ceil(std::max(_zoomExponent, 0.0)));
+	return BigReal::LimbsFor(pixelBits + CameraGuardBits);
+}
+
+auto FractalManager::PixelSpacing() const -> ExtendedReal
+{
+	// 2^-zoom, split so the whole part never has to fit a double
+	const auto whole = std::floor(_zoomExponent);
+	return {std::exp2(whole - _zoomExponent), -static_cast<int64_t>(whole)};
+}
+
+auto FractalManager::GenerateSimBox() const -> SimBox
 {
 	switch (_precision)
 	{
 	case FractalGenerationPrecision::Bit32:
 	{
-		const auto& [topLeft, botRight] = camera.Viewport();
-		return SimBox{Position(topLeft.x, topLeft.y), Position(botRight.x, botRight.y)};
+		// The view as a float camera would see it
+		const auto position = CameraPosition();
+		const auto spacing = static_cast<float>(PixelSpacing().ToDouble());
+		return SimBox{
+			BigReal(static_cast<float>(position.x), CameraLimbs()),
+			BigReal(static_cast<float>(position.y), CameraLimbs()), ExtendedReal(spacing), _viewportSize
+		};
 	}
 	case FractalGenerationPrecision::Bit64:
+	case FractalGenerationPrecision::DoubleDouble:
+	case FractalGenerationPrecision::Automatic:
 	{
-		const auto vpSize = _viewportSize;
-		const sf::Rect<double> screenRect = {{0.0, 0.0}, {vpSize.x, vpSize.y}};
-		const auto TL = Position(screenRect.left, screenRect.top);
-		const auto BR = Position(screenRect.left + screenRect.width, screenRect.top + screenRect.height);
-		const auto inv = _cameraTransform.Inverse();
-
-		const auto [topLeft, topRight] = std::make_pair(inv.TransformPoint(TL), inv.TransformPoint(BR));
-
-		return SimBox{Position(topLeft.x, topLeft.y), Position(topRight.x, topRight.y)};
+		return SimBox{_cameraX, _cameraY, PixelSpacing(), _viewportSize};
 	}
 	}
 
 	Debug::Break("Invalid precision type");
-	return {{0, 0}, {0, 0}};
+	return {Position(), Position()};
 }
 
 auto FractalManager::ActiveFractalSet() -> FractalSet&
@@ -10,12 +10,27 @@ namespace Se
 enum class FractalGenerationPrecision
 {
 	Bit32,
-	Bit64
+	Bit64,
+	// Pairs of doubles on the CPU, the GPU hosts stay at 64-bit
+	DoubleDouble,
+	// CPU kernels switch to 32-bit or double-double as the zoom requires
+	Automatic
 };
 
 class FractalManager
 {
 public:
+	// Most iterations the zoom picks on its own, higher on the perturbation host whose
+	// approximations skip most of a deep orbit
+	static constexpr ulong AutoIterationCap = 2000;
+	static constexpr ulong DeepAutoIterationCap = 1000000;
+	// Pixels per unit after a reset
+	static constexpr double DefaultZoom = 200.0;
+	// Bits the camera centre keeps below a pixel
+	static constexpr int CameraGuardBits = 64;
+	// The engine camera only takes a rounded copy of the zoom, overlays are meaningless past it
+	static constexpr double MaxTransformZoomExponent = 1000.0;
+
 	explicit FractalManager(const sf::Vector2f& renderSize);
 
 	void OnUpdate(Scene& scene);
@@ -51,7 +66,15 @@ private:
 	void UpdateHighPrecCamera();
 	void UpdateTransform();
 
-	auto GenerateSimBox(const Camera& camera) const -> SimBox;
+	// Moves the camera centre by a distance in pixels
+	void MoveCamera(const Position& pixels);
+	void SetCameraPosition(const Position& position);
+	// The camera centre rounded to double, for the engine camera and the GUI
+	auto CameraPosition() const -> Position;
+	auto CameraLimbs() const -> int;
+	auto PixelSpacing() const -> ExtendedReal;
+
+	auto GenerateSimBox() const -> SimBox;
 
 	auto ActiveFractalSet() -> FractalSet&;
 	auto ActiveFractalSet() const -> const FractalSet&;
@@ -75,13 +98,14 @@ private:
 	int _activeFractalSetInt = static_cast<int>(FractalSetType::Mandelbrot);
 	int _activePaletteInt = static_cast<int>(PaletteType::Fiery);
 	int _hostInt = -1;
-	int _activePrecisionInt = static_cast<int>(FractalGenerationPrecision::Bit64);
+	int _activePrecisionInt = static_cast<int>(FractalGenerationPrecision::Automatic);
 	int _fractalSetGenerationTypeInt = static_cast<int>(FractalSetGenerationType::AutomaticGeneration);
 	int _computeIterations = 64;
 	bool _juliaDrawComplexLines = false;
 	bool _mandelbrotDrawComplexLines = false;
 	bool _juliaDrawCDot = false;
-	ulong _zoom = 200;
+	// Compute outwards from the cursor instead of the centre of the image
+	bool _cursorFocus = false;
 
 	// Animate camera movement
 	Position _desiredCameraPos;
@@ -89,6 +113,7 @@ private:
 	double _positionTransitionDuration = 0.9;
 	double _positionTransitionTimer = _positionTransitionDuration + 1.0;
 
+	// Zoom exponents, transitions interpolate them so the speed looks the same at any depth
 	double _desiredZoom = 0.0;
 	double _desiredZoomLater = 0.0;
 	double _startZoom = 0.0;
@@ -97,6 +122,7 @@ private:
 
 	// Common
 	bool _manualSetIterations = false;
+	size_t _autoComputeIterations = 0;
 	
 	// Julia
 	int _juliaStateInt = static_cast<int>(JuliaState::None);
@@ -109,13 +135,13 @@ private:
 	bool _axis = false;
 
 	// Precision
-	FractalGenerationPrecision _precision = FractalGenerationPrecision::Bit64;
+	FractalGenerationPrecision _precision = FractalGenerationPrecision::Automatic;
 
-	// High precision transform
-	Position _cameraPosition;
-	Position _cameraZoom = {1.0, 1.0};
-	Transform<double> _cameraZoomTransform;
-	Transform<double> _cameraPositionTransform;
+	// The camera centre to as many bits as the zoom needs, and log2 of the pixels per unit.
+	// The transform is a double copy of them for the engine camera.
+	BigReal _cameraX;
+	BigReal _cameraY;
+	double _zoomExponent = 0.0;
 	Transform<double> _cameraTransform;
 	Position _viewportSize;
 };
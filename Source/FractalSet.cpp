@@ -8,15 +8,56 @@
 
 namespace Se
 {
+namespace
+{
+// The leading 106 bits, the remainder is what the double of the upper half left out
+auto ToDoubleDouble(const BigReal& value) -> DoubleDouble
+{
+	const double hi = value.ToDouble();
+	return {hi, (value - BigReal(hi, value.FractionLimbs())).ToDouble()};
+}
+}
+
 SimBox::SimBox(const Position& topLeft, const Position& bottomRight) :
 	TopLeft(topLeft),
-	BottomRight(bottomRight)
+	BottomRight(bottomRight),
+	PreciseTopLeft(topLeft),
+	PreciseBottomRight(bottomRight)
+{
+}
+
+SimBox::SimBox(const PrecisePosition& topLeft, const PrecisePosition& bottomRight) :
+	TopLeft(topLeft.ToPosition()),
+	BottomRight(bottomRight.ToPosition()),
+	PreciseTopLeft(topLeft),
+	PreciseBottomRight(bottomRight)
+{
+}
+
+SimBox::SimBox(BigReal centerX, BigReal centerY, const ExtendedReal& spacing, const Position& size) :
+	CenterX(std::move(centerX)),
+	CenterY(std::move(centerY)),
+	Spacing(spacing)
 {
+	// Deep enough to hold the half size's digits below the centre's
+	const int64_t spacingBits = std::max<int64_t>(0, 1 - Spacing.Exponent);
+	const int limbs = std::max({
+		CenterX.FractionLimbs(), CenterY.FractionLimbs(),
+		BigReal::LimbsFor(static_cast<int>(spacingBits) + 2 * 53)
+	});
+	const BigReal halfWidth(ExtendedReal(size.x / 2.0) * Spacing, limbs);
+	const BigReal halfHeight(ExtendedReal(size.y / 2.0) * Spacing, limbs);
+
+	PreciseTopLeft = {ToDoubleDouble(CenterX - halfWidth), ToDoubleDouble(CenterY - halfHeight)};
+	PreciseBottomRight = {ToDoubleDouble(CenterX + halfWidth), ToDoubleDouble(CenterY + halfHeight)};
+	TopLeft = PreciseTopLeft.ToPosition();
+	BottomRight = PreciseBottomRight.ToPosition();
 }
 
 auto SimBox::operator==(const SimBox& other) const -> bool
 {
-	return TopLeft == other.TopLeft && BottomRight == other.BottomRight;
+	return PreciseTopLeft == other.PreciseTopLeft && PreciseBottomRight == other.PreciseBottomRight &&
+		CenterX == other.CenterX && CenterY == other.CenterY && Spacing == other.Spacing;
 }
 
 auto SimBox::operator!=(const SimBox& other) const -> bool
@@ -82,16 +123,18 @@ FractalSet::FractalSet(std::string name, FractalSetType type, const sf::Vector2f
 
 void FractalSet::OnUpdate(Scene& scene)
 {
-	const auto start = Global::Clock::SinceStart();
-
-	ActiveHost().OnUpdate(scene);
-	if (_generationType == FractalSetGenerationType::DelayedGeneration)
+	if (_generationPending)
 	{
-		if (start - _lastGenerationRequest > sf::seconds(0.2f))
+		const bool quiet = Global::Clock::SinceStart() - _lastGenerationRequest > sf::seconds(GenerationDelay);
+		if (_generationType != FractalSetGenerationType::DelayedGeneration || quiet)
 		{
-			_lastGenerationRequest = start;
+			ActiveHost().RequestImageComputation();
+			_generationPending = false;
+			_generations++;
 		}
 	}
+
+	ActiveHost().OnUpdate(scene);
 }
 
 void FractalSet::OnRender(Scene& scene)
@@ -116,6 +159,14 @@ void FractalSet::RequestImageRendering() noexcept
 	ActiveHost().RequestImageRendering();
 }
 
+void FractalSet::CancelComputation()
+{
+	for (auto& host : _hosts | std::views::values)
+	{
+		host->CancelComputation();
+	}
+}
+
 void FractalSet::AddHost(std::unique_ptr<Host> host)
 {
 	_hosts.emplace(host->Type(), std::move(host));
@@ -123,8 +174,18 @@ void FractalSet::AddHost(std::unique_ptr<Host> host)
 
 void FractalSet::RequestImageComputation() noexcept
 {
+	_generationRequests++;
+	if (!_active)
+	{
+		_droppedRequests++;
+		return;
+	}
+	if (_generationPending)
+	{
+		_mergedRequests++;
+	}
+	_generationPending = true;
 	_lastGenerationRequest = Global::Clock::SinceStart();
-	ActiveHost().RequestImageComputation();
 }
 
 auto FractalSet::Name() const noexcept -> const std::string&
@@ -192,6 +253,45 @@ void FractalSet::SetGenerationType(FractalSetGenerationType type)
 	RequestImageRendering();
 }
 
+auto FractalSet::Active() const -> bool
+{
+	return _active;
+}
+
+void FractalSet::SetActive(bool active)
+{
+	_active = active;
+	if (!_active)
+	{
+		if (_generationPending)
+		{
+			_droppedRequests++;
+			_generationPending = false;
+		}
+		CancelComputation();
+	}
+}
+
+auto FractalSet::GenerationRequests() const -> size_t
+{
+	return _generationRequests;
+}
+
+auto FractalSet::Generations() const -> size_t
+{
+	return _generations;
+}
+
+auto FractalSet::MergedRequests() const -> size_t
+{
+	return _mergedRequests;
+}
+
+auto FractalSet::DroppedRequests() const -> size_t
+{
+	return _droppedRequests;
+}
+
 void FractalSet::ActivateAxis()
 {
 	_drawAxis = true;
@@ -36,6 +36,9 @@ struct FractalSetPlace
 class FractalSet
 {
 public:
+	// How long delayed generation waits for requests to stop coming before computing
+	static constexpr float GenerationDelay = 0.2f;
+
 	FractalSet(std::string name, FractalSetType type, const sf::Vector2f& renderSize);
 	virtual ~FractalSet() = default;
 
@@ -43,8 +46,12 @@ public:
 	virtual void OnRender(Scene& scene);
 	virtual void OnViewportResize(const sf::Vector2f& size);
 
+	// Requests are merged and handed to the host on the next update, or once none came in for
+	// GenerationDelay with delayed generation. Inactive sets drop them.
 	void RequestImageComputation() noexcept;
 	void RequestImageRendering() noexcept;
+	// Stops whatever every host is computing in the background
+	void CancelComputation();
 
 	void AddHost(std::unique_ptr<Host> host);
 
@@ -64,6 +71,17 @@ public:
 	auto GenerationType() const -> FractalSetGenerationType;
 	void SetGenerationType(FractalSetGenerationType type);
 
+	// Only the active set computes, deactivating cancels what its hosts are working on
+	auto Active() const -> bool;
+	void SetActive(bool active);
+
+	// Computation requests received, computations they led to, and the requests that were
+	// merged into one already waiting or dropped while inactive
+	auto GenerationRequests() const -> size_t;
+	auto Generations() const -> size_t;
+	auto MergedRequests() const -> size_t;
+	auto DroppedRequests() const -> size_t;
+
 	void ActivateAxis();
 	void DeactivateAxis();
 
@@ -96,8 +114,14 @@ protected:
 	SimBox _simBox;
 
 private:
-	// For delayed image generation
+	// For merging and delaying image generation
 	sf::Time _lastGenerationRequest;
+	bool _generationPending = false;
+	bool _active = false;
+	size_t _generationRequests = 0;
+	size_t _generations = 0;
+	size_t _mergedRequests = 0;
+	size_t _droppedRequests = 0;
 
 	// Axis
 	bool _drawAxis = false;
@@ -82,81 +82,62 @@ void Buddhabrot::UpdateComputeShaderUniforms(ComputeShader& shader)
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _ssbo);
 }
 
-void Buddhabrot::BuddhabrotWorker::Compute()
+void Buddhabrot::BuddhabrotWorker::ComputeSpan(int x, int y, int count, int stride)
 {
 	return;
 	// Todo: Fix this
-	while (Alive)
-	{
-		std::unique_lock lm(Mutex);
-		CvStart.wait(lm);
-		if (!Alive)
-		{
-			++(*WorkerComplete);
-			return;
-		}
-		// Somehow declaring this variable fixes a race condition
-		int bugfixer = 0;
+	const double xScale = XScale;
+	const double yScale = YScale;
+	const int imageHeight = y + 1;
 
-		const double xScale = (FractalBR.x - FractalTL.x) / (ImageBR.x - ImageTL.x);
-		const double yScale = (FractalBR.y - FractalTL.y) / (ImageBR.y - ImageTL.y);
+	auto mandelbrotIterations = [this](const Position& fractalCoord)
+	{
+		Position z;
+		const Position c = fractalCoord;
 
-		auto mandelbrotIterations = [this](const Position& fractalCoord)
+		int n = 0;
+		for (double result = 0.0; n <= Iterations && result < 4.0; n++)
 		{
-			Position z;
-			const Position c = fractalCoord;
+			const double zRealTmp = z.x;
+			z.x = (zRealTmp * zRealTmp) - (z.y * z.y) + c.x;
+			z.y = 2.0 * zRealTmp * z.y + c.y;
+			result = VecUtils::Dot(z, z);
+		}
+		return n;
+	};
 
-			int n = 0;
-			for (double result = 0.0; n <= Iterations && result < 4.0; n++)
-			{
-				const double zRealTmp = z.x;
-				z.x = (zRealTmp * zRealTmp) - (z.y * z.y) + c.x;
-				z.y = 2.0 * zRealTmp * z.y + c.y;
-				result = VecUtils::Dot(z, z);
-			}
-			return n;
-		};
+	auto mandelbrotRecord = [this, xScale, yScale, imageHeight](const Position& fractalCoord)
+	{
+		Position z;
+		const Position c = fractalCoord;
 
-		auto mandelbrotRecord = [this, xScale, yScale](const Position& fractalCoord)
+		for (int n = 0; n < Iterations && VecUtils::Dot(z, z) < 4.0; n++)
 		{
-			Position z;
-			const Position c = fractalCoord;
-
-			for (int n = 0; n < Iterations && VecUtils::Dot(z, z) < 4.0; n++)
-			{
-				const double zRealTmp = z.x;
-				z.x = (zRealTmp * zRealTmp) - (z.y * z.y) + c.x;
-				z.y = 2.0 * zRealTmp * z.y + c.y;
+			const double zRealTmp = z.x;
+			z.x = (zRealTmp * zRealTmp) - (z.y * z.y) + c.x;
+			z.y = 2.0 * zRealTmp * z.y + c.y;
 
 
-				const int x = (z.x - FractalTL.x) / xScale;
-				const int y = (z.y - FractalTL.y) / yScale;
+			const int x = (z.x - FractalTL.x) / xScale;
+			const int y = (z.y - FractalTL.y) / yScale;
 
-				const auto index = SimWidth * y + x;
+			const auto index = SimWidth * y + x;
 
-				if (index >= 0 && index < ImageBR.y * SimWidth)
-				{
-					FractalArray[index] = 10;
-				}
-			}
-		};
-
-		for (int y = ImageTL.y; y < ImageBR.y; y++)
-		{
-			for (int x = ImageTL.x; x < ImageBR.x; x += 4)
+			if (index >= 0 && index < imageHeight * SimWidth)
 			{
-				const Position coord(static_cast<double>(x) * xScale, static_cast<double>(y) * yScale);
-
-				const auto iterations = mandelbrotIterations(coord);
-				if (iterations >= Iterations) continue;
+				FractalArray[index] = 10;
+			}
+		}
+	};
 
-				mandelbrotRecord(coord);
+	for (int i = 0; i < count; i += 4)
+	{
+		const Position coord(static_cast<double>(x + i * stride) * xScale, static_cast<double>(y) * yScale);
 
+		const auto iterations = mandelbrotIterations(coord);
+		if (iterations >= Iterations) continue;
 
-				const int highestIndex = ImageBR.y * SimWidth;
-			}
-		}
-		++(*WorkerComplete);
+		mandelbrotRecord(coord);
 	}
 }
 }
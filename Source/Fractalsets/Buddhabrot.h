@@ -28,7 +28,7 @@ private:
 private:
 	struct BuddhabrotWorker : Worker
 	{
-		void Compute() override;
+		void ComputeSpan(int x, int y, int count, int stride) override;
 	};
 };
 }
@@ -1,6 +1,6 @@
 #include "Julia.h"
 
-#include <Saffron/Core/SIMD.h>
+#include <bit>
 
 namespace Se
 {
@@ -9,15 +9,15 @@ Julia::Julia(const sf::Vector2f& renderSize) :
 {
 	const auto x = renderSize.x, y = renderSize.y;
 
-	auto cpuHost = std::make_unique<CpuHost>(x, y);
+	auto cpuHost = std::make_unique<CpuHost>(x, y, [this]
+	{
+		auto worker = std::make_unique<JuliaWorker>();
+		worker->C = _currentC;
+		return worker;
+	});
 	auto comHost = std::make_unique<ComputeShaderHost>("julia.comp", x, y, sf::Vector2u(x, y));
 	auto pixHost = std::make_unique<PixelShaderHost>("julia.frag", x, y);
 
-	for (int i = 0; i < 32; i++)
-	{
-		cpuHost->AddWorker(std::make_unique<JuliaWorker>());
-	}
-
 	comHost->RequestUniformUpdate += [this](ComputeShader& shader)
 	{
 		UpdateComputeShaderUniforms(shader);
@@ -87,11 +87,28 @@ void Julia::OnUpdate(Scene& scene)
 
 	if (_activeHost == HostType::Cpu)
 	{
-		for (auto& worker : ActiveHost().As<CpuHost>().Workers())
+		auto& cpuHost = ActiveHost().As<CpuHost>();
+		const auto& workers = cpuHost.Workers();
+		const bool changed = std::any_of(workers.begin(), workers.end(), [this](const auto& worker)
 		{
-			auto& juliaWorker = dynamic_cast<JuliaWorker&>(*worker);
-			juliaWorker.C = _currentC;
+			return dynamic_cast<const JuliaWorker&>(*worker).C != _currentC;
+		});
+		if (changed)
+		{
+			// A new C changes every pixel, the running frame and panned results are of no use.
+			// Invalidate waits for the frame, so the workers are free to take the new C.
+			cpuHost.Invalidate();
+			for (auto& worker : cpuHost.Workers())
+			{
+				dynamic_cast<JuliaWorker&>(*worker).C = _currentC;
+			}
 		}
+
+		// Set once the frame of the old C is done with, workers made later take the current C too
+		uint64_t cacheKey = TileCache::Combine(0, static_cast<uint64_t>(_type));
+		cacheKey = TileCache::Combine(cacheKey, std::bit_cast<uint64_t>(_currentC.real()));
+		cacheKey = TileCache::Combine(cacheKey, std::bit_cast<uint64_t>(_currentC.imag()));
+		cpuHost.SetCacheKey(cacheKey);
 	}
 
 	FractalSet::OnUpdate(scene);
@@ -234,95 +251,19 @@ void Julia::UpdatePixelShaderUniforms(sf::Shader& shader)
 	SetUniform(shader.getNativeHandle(), "iterations", static_cast<int>(_computeIterations));
 }
 
-void Julia::JuliaWorker::Compute()
+void Julia::JuliaWorker::ComputeSpan(int x, int y, int count, int stride)
 {
-	while (Alive)
-	{
-		std::unique_lock lm(Mutex);
-		CvStart.wait(lm);
-		if (!Alive)
-		{
-			WorkerComplete++;
-			return;
-		}
-
-		double xScale = (FractalBR.x - FractalTL.x) / (ImageBR.x - ImageTL.x);
-		double yScale = (FractalBR.y - FractalTL.y) / (ImageBR.y - ImageTL.y);
-
-		double y_pos = FractalTL.y;
-
-		int y_offset = 0;
-		int row_size = SimWidth;
-
-		int x, y;
-
-		SIMD_Double _a, _b, _two, _four, _mask1;
-		SIMD_Double _zr, _zi, _zr2, _zi2, _cr, _ci;
-		SIMD_Double _x_pos_offsets, _x_pos, _x_scale, _x_jump;
-		SIMD_Integer _one, _c, _n, _iterations, _mask2;
-
-		_one = SIMD_SetOnei(1);
-		_two = SIMD_SetOne(2.0);
-		_four = SIMD_SetOne(4.0);
-		_iterations = SIMD_SetOnei(Iterations);
-
-		_x_scale = SIMD_SetOne(xScale);
-		_x_jump = SIMD_SetOne(xScale * 4.0);
-		_x_pos_offsets = SIMD_Set(0.0, 1.0, 2.0, 3.0);
-		_x_pos_offsets = SIMD_Mul(_x_pos_offsets, _x_scale);
-
-		_cr = SIMD_SetOne(C.real());
-		_ci = SIMD_SetOne(-C.imag()); // The negative sign is intentional
-
-		for (y = ImageTL.y; y < ImageBR.y; y++)
-		{
-			// Reset x_position
-			_a = SIMD_SetOne(FractalTL.x);
-			_x_pos = SIMD_Add(_a, _x_pos_offsets);
-
-			for (x = ImageTL.x; x < ImageBR.x; x += 4)
-			{
-				_zr = _x_pos;
-				_zi = SIMD_SetOne(y_pos);
-				_n = SIMD_SetZero256i();
-
-			repeat: _zr2 = SIMD_Mul(_zr, _zr);
-				_zi2 = SIMD_Mul(_zi, _zi);
-				_a = SIMD_Sub(_zr2, _zi2);
-				_a = SIMD_Add(_a, _cr);
-				_b = SIMD_Mul(_zr, _zi);
-				_b = SIMD_Mul(_b, _two);
-				_b = SIMD_Add(_b, _ci);
-				_zr = _a;
-				_zi = _b;
-				_a = SIMD_Add(_zr2, _zi2);
-				_mask1 = SIMD_LessThan(_a, _four);
-				_mask2 = SIMD_GreaterThani(_iterations, _n);
-				_mask2 = SIMD_Andi(_mask2, SIMD_CastToInt(_mask1));
-				_c = SIMD_Andi(_one, _mask2); // Zero out ones where n < iterations
-				_n = SIMD_Addi(_n, _c); // n++ Increase all n
-				if (SIMD_SignMask(SIMD_CastToFloat(_mask2)) > 0) goto repeat;
-
-#if defined(__MINGW32__)
-				fractalArray[y_offset + x + 0] = static_cast<int>(_n[3]);
-				fractalArray[y_offset + x + 1] = static_cast<int>(_n[2]);
-				fractalArray[y_offset + x + 2] = static_cast<int>(_n[1]);
-				fractalArray[y_offset + x + 3] = static_cast<int>(_n[0]);
-#elif defined (_MSC_VER)
-				FractalArray[y_offset + x + 0] = static_cast<int>(_n.m256i_i64[3]);
-				FractalArray[y_offset + x + 1] = static_cast<int>(_n.m256i_i64[2]);
-				FractalArray[y_offset + x + 2] = static_cast<int>(_n.m256i_i64[1]);
-				FractalArray[y_offset + x + 3] = static_cast<int>(_n.m256i_i64[0]);
-#endif
-
-				_x_pos = SIMD_Add(_x_pos, _x_jump);
-			}
-
-			y_pos += yScale;
-			y_offset += row_size;
-		}
+	Kernels::SpanStats stats;
+	// The negative sign is intentional
+	Functions().Julia(MakeSpan(x, y, count, stride), C.real(), -C.imag(), stats);
+	AddStats(stats);
+}
 
-		++(*WorkerComplete);
-	}
+void Julia::JuliaWorker::ComputeRuns(const std::vector<Run>& runs)
+{
+	Kernels::SpanStats stats;
+	const auto& spans = MakeSpans(runs);
+	Functions().JuliaStream(spans.data(), spans.size(), C.real(), -C.imag(), stats);
+	AddStats(stats);
 }
 }
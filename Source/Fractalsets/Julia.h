@@ -74,7 +74,9 @@ private:
 private:
 	struct JuliaWorker : Worker
 	{
-		void Compute() override;
+		void ComputeSpan(int x, int y, int count, int stride) override;
+		void ComputeRuns(const std::vector<Run>& runs) override;
+		auto SupportsSubdivision() const -> bool override { return true; }
 
 		std::complex<double> C;
 	};
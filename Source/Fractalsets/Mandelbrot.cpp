@@ -2,28 +2,48 @@
 
 #include <glad/glad.h>
 
-#include <Saffron/Core/SIMD.h>
-
 #include "ComputeHosts/CpuHost.h"
 #include "ComputeHosts/ComputeShaderHost.h"
 #include "ComputeHosts/PixelShaderHost.h"
+#include "ComputeHosts/PerturbationHost.h"
 
 namespace Se
 {
+namespace
+{
+// Matches local_size_x and local_size_y in mandelbrot.comp
+constexpr uint ComputeGroupSize = 8;
+
+auto ComputeGroups(const sf::Vector2u& size) -> sf::Vector2u
+{
+	return {(size.x + ComputeGroupSize - 1) / ComputeGroupSize, (size.y + ComputeGroupSize - 1) / ComputeGroupSize};
+}
+}
+
 Mandelbrot::Mandelbrot(const sf::Vector2f& renderSize) :
 	FractalSet("Mandelbrot", FractalSetType::Mandelbrot, renderSize),
 	_drawFlags(MandelbrotDrawFlags_None)
 {
+	const GLuint zero = 0;
+	glGenBuffers(1, &_skippedSsbo);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _skippedSsbo);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &zero, GL_DYNAMIC_READ);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
 	const auto x = renderSize.x, y = renderSize.y;
 
-	auto cpuHost = std::make_unique<CpuHost>(x, y);
-	auto comHost = std::make_unique<ComputeShaderHost>("mandelbrot.comp", x, y, sf::Vector2u(x, y));
+	auto cpuHost = std::make_unique<CpuHost>(x, y, []
+	{
+		return std::make_unique<MandelbrotWorker>();
+	});
+	auto comHost = std::make_unique<ComputeShaderHost>("mandelbrot.comp", x, y, ComputeGroups(sf::Vector2u(x, y)));
 	auto pixHost = std::make_unique<PixelShaderHost>("mandelbrot.frag", x, y);
+	auto perturbationHost = std::make_unique<PerturbationHost>(x, y);
 
-	for (int i = 0; i < 32; i++)
-	{
-		cpuHost->AddWorker(std::make_unique<MandelbrotWorker>());
-	}
+	// Both CPU hosts give the same pixels where their precision is the same
+	const uint64_t cacheKey = TileCache::Combine(0, static_cast<uint64_t>(_type));
+	cpuHost->SetCacheKey(cacheKey);
+	perturbationHost->SetCacheKey(cacheKey);
 
 	comHost->RequestUniformUpdate += [this](ComputeShader& shader)
 	{
@@ -40,10 +60,16 @@ Mandelbrot::Mandelbrot(const sf::Vector2f& renderSize) :
 	AddHost(std::move(cpuHost));
 	AddHost(std::move(comHost));
 	AddHost(std::move(pixHost));
+	AddHost(std::move(perturbationHost));
 
 	_places.push_back({"Elephant Valley", {0.3, 0.0}, 700});
 }
 
+Mandelbrot::~Mandelbrot()
+{
+	glDeleteBuffers(1, &_skippedSsbo);
+}
+
 auto Mandelbrot::DrawFlags() const -> MandelbrotDrawFlags
 {
 	return _drawFlags;
@@ -67,6 +93,20 @@ auto Mandelbrot::TranslatePoint(const sf::Vector2f& point, int iterations) -> sf
 	return sf::Vector2f(z.real(), z.imag());
 }
 
+auto Mandelbrot::SkippedPixels() const -> size_t
+{
+	if (_activeHost == HostType::Cpu || _activeHost == HostType::CpuPerturbation)
+	{
+		return ActiveHost().As<CpuHost>().SkippedPixels();
+	}
+
+	GLuint skipped = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _skippedSsbo);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &skipped);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return skipped;
+}
+
 void Mandelbrot::OnRender(Scene& scene)
 {
 	FractalSet::OnRender(scene);
@@ -89,7 +129,7 @@ void Mandelbrot::OnViewportResize(const sf::Vector2f& size)
 {
 	FractalSet::OnViewportResize(size);
 	const auto sizeU = VecUtils::ConvertTo<sf::Vector2u>(size);
-	_hosts.at(HostType::GpuComputeShader)->As<ComputeShaderHost>().SetDimensions(sizeU);
+	_hosts.at(HostType::GpuComputeShader)->As<ComputeShaderHost>().SetDimensions(ComputeGroups(sizeU));
 }
 
 void Mandelbrot::UpdateComputeShaderUniforms(ComputeShader& shader)
@@ -100,6 +140,8 @@ void Mandelbrot::UpdateComputeShaderUniforms(ComputeShader& shader)
 	shader.SetDouble("xScale", xScale);
 	shader.SetDouble("yScale", yScale);
 	shader.SetInt("iterations", _computeIterations);
+
+	ResetSkippedCounter();
 }
 
 void Mandelbrot::UpdatePixelShaderUniforms(sf::Shader& shader)
@@ -111,99 +153,32 @@ void Mandelbrot::UpdatePixelShaderUniforms(sf::Shader& shader)
 	SetUniform(shader.getNativeHandle(), "xScale", xScale);
 	SetUniform(shader.getNativeHandle(), "yScale", yScale);
 	SetUniform(shader.getNativeHandle(), "iterations", static_cast<int>(_computeIterations));
+	SetUniform(shader.getNativeHandle(), "simWidth", static_cast<int>(_simWidth));
+
+	ResetSkippedCounter();
 }
 
-void Mandelbrot::MandelbrotWorker::Compute()
+void Mandelbrot::ResetSkippedCounter()
 {
-	while (Alive)
-	{
-		std::unique_lock lm(Mutex);
-		CvStart.wait(lm);
-		if (!Alive)
-		{
-			++(*WorkerComplete);
-			return;
-		}
-		// Somehow declaring this variable fixes a race condition
-		int bugfixer = 0;
-
-		double xScale = (FractalBR.x - FractalTL.x) / (ImageBR.x - ImageTL.x);
-		double yScale = (FractalBR.y - FractalTL.y) / (ImageBR.y - ImageTL.y);
-
-		double yPos = FractalTL.y;
-
-		int yOffset = 0;
-		int rowSize = SimWidth;
-
-		int x, y;
-
-		SIMD_Double a, b, two, four, mask1;
-		SIMD_Double zr, zi, zr2, zi2, cr, ci;
-		SIMD_Double xPosOffsets, xPos, xScaleSimd, xJump;
-		SIMD_Integer one, c, n, iterations, mask2;
-
-		one = SIMD_SetOnei(1);
-		two = SIMD_SetOne(2.0);
-		four = SIMD_SetOne(4.0);
-		iterations = SIMD_SetOnei(Iterations);
+	const GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _skippedSsbo);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _skippedSsbo);
+}
 
-		xScaleSimd = SIMD_SetOne(xScale);
-		xJump = SIMD_SetOne(xScale * 4.0);
-		xPosOffsets = SIMD_Set(0.0, 1.0, 2.0, 3.0);
-		xPosOffsets = SIMD_Mul(xPosOffsets, xScaleSimd);
+void Mandelbrot::MandelbrotWorker::ComputeSpan(int x, int y, int count, int stride)
+{
+	Kernels::SpanStats stats;
+	Functions().Mandelbrot(MakeSpan(x, y, count, stride), stats);
+	AddStats(stats);
+}
 
-		for (y = ImageTL.y; y < ImageBR.y; y++)
-		{
-			// Reset x_position
-			a = SIMD_SetOne(FractalTL.x);
-			xPos = SIMD_Add(a, xPosOffsets);
-
-			ci = SIMD_SetOne(yPos);
-
-			for (x = ImageTL.x; x < ImageBR.x; x += 4)
-			{
-				cr = xPos;
-				zr = SIMD_SetZero();
-				zi = SIMD_SetZero();
-				n = SIMD_SetZero256i();
-
-			repeat: zr2 = SIMD_Mul(zr, zr);
-				zi2 = SIMD_Mul(zi, zi);
-				a = SIMD_Sub(zr2, zi2);
-				a = SIMD_Add(a, cr);
-				b = SIMD_Mul(zr, zi);
-				b = SIMD_Mul(b, two);
-				b = SIMD_Add(b, ci);
-				zr = a;
-				zi = b;
-				a = SIMD_Add(zr2, zi2);
-				mask1 = SIMD_LessThan(a, four);
-				mask2 = SIMD_GreaterThani(iterations, n);
-				mask2 = SIMD_Andi(mask2, SIMD_CastToInt(mask1));
-				c = SIMD_Andi(one, mask2); // Zero out ones where n < iterations
-				n = SIMD_Addi(n, c); // n++ Increase all n
-				if (SIMD_SignMask(SIMD_CastToFloat(mask2)) > 0) goto repeat;
-
-#if defined(__MINGW32__)
-				fractalArray[y_offset + x + 0] = static_cast<int>(_n[3]);
-				fractalArray[y_offset + x + 1] = static_cast<int>(_n[2]);
-				fractalArray[y_offset + x + 2] = static_cast<int>(_n[1]);
-				fractalArray[y_offset + x + 3] = static_cast<int>(_n[0]);
-#elif defined (_MSC_VER)
-				FractalArray[yOffset + x + 0] = static_cast<int>(n.m256i_i64[3]);
-				FractalArray[yOffset + x + 1] = static_cast<int>(n.m256i_i64[2]);
-				FractalArray[yOffset + x + 2] = static_cast<int>(n.m256i_i64[1]);
-				FractalArray[yOffset + x + 3] = static_cast<int>(n.m256i_i64[0]);
-#endif
-
-				xPos = SIMD_Add(xPos, xJump);
-			}
-
-
-			yPos += yScale;
-			yOffset += rowSize;
-		}
-		++(*WorkerComplete);
-	}
+void Mandelbrot::MandelbrotWorker::ComputeRuns(const std::vector<Run>& runs)
+{
+	Kernels::SpanStats stats;
+	const auto& spans = MakeSpans(runs);
+	Functions().MandelbrotStream(spans.data(), spans.size(), stats);
+	AddStats(stats);
 }
 }
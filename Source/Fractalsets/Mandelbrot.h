@@ -20,7 +20,7 @@ class Mandelbrot : public FractalSet
 {
 public:
 	explicit Mandelbrot(const sf::Vector2f& renderSize);
-	~Mandelbrot() override = default;
+	~Mandelbrot() override;
 
 	void OnRender(Scene& scene) override;
 	void OnViewportResize(const sf::Vector2f& size) override;
@@ -30,18 +30,25 @@ public:
 
 	static auto TranslatePoint(const sf::Vector2f& point, int iterations)->sf::Vector2f;
 
+	// Pixels of the last frame that the cardioid and bulb test proved interior
+	auto SkippedPixels() const -> size_t;
+
 private:
 	void UpdateComputeShaderUniforms(ComputeShader& shader);
 	void UpdatePixelShaderUniforms(sf::Shader& shader);
+	void ResetSkippedCounter();
 
 private:
 
 	MandelbrotDrawFlags _drawFlags;
+	uint _skippedSsbo;
 
 private:
 	struct MandelbrotWorker : Worker
 	{
-		void Compute() override;
+		void ComputeSpan(int x, int y, int count, int stride) override;
+		void ComputeRuns(const std::vector<Run>& runs) override;
+		auto SupportsSubdivision() const -> bool override { return true; }
 	};
 };
 }
@@ -1,5 +1,7 @@
 ﻿#include "Host.h"
 
+#include <algorithm>
+
 namespace Se
 {
 Host::Host(HostType type, std::string name, int simWidth, int simHeight) :
@@ -13,7 +15,7 @@ Host::Host(HostType type, std::string name, int simWidth, int simHeight) :
 
 void Host::OnUpdate(Scene& scene)
 {
-	if (_computationRequested)
+	if (_computationRequested || _computationContinued)
 	{
 		if (_resizeRequsted)
 		{
@@ -21,8 +23,11 @@ void Host::OnUpdate(Scene& scene)
 			_simWidth = _desiredSize.x;
 			_simHeight = _desiredSize.y;
 			_resizeRequsted = false;
+			// Nothing worked out for the old size carries over, even when this frame only continues
+			_computationRequested = true;
 		}
 
+		_computationContinued = false;
 		ComputeImage();
 		_computationRequested = false;
 	}
@@ -67,9 +72,34 @@ void Host::RequestResize(const sf::Vector2f& desiredSize)
 
 void Host::SetComputeIterations(ulong computeIterations)
 {
+	// A running computation must not see its parameters change under it
+	if (computeIterations != _computeIterations)
+	{
+		CancelComputation();
+	}
 	_computeIterations = computeIterations;
 }
 
+auto Host::FrameBudget() const -> double
+{
+	return _frameBudget;
+}
+
+void Host::SetFrameBudget(double milliseconds)
+{
+	_frameBudget = std::max(milliseconds, 0.0);
+}
+
+auto Host::Focus() const -> const std::optional<sf::Vector2f>&
+{
+	return _focus;
+}
+
+void Host::SetFocus(std::optional<sf::Vector2f> focus)
+{
+	_focus = focus;
+}
+
 auto Host::SimBox() const -> const struct SimBox&
 {
 	return _simBox;
@@ -77,9 +107,18 @@ auto Host::SimBox() const -> const struct SimBox&
 
 void Host::SetSimBox(const Se::SimBox& simBox)
 {
+	if (simBox != _simBox)
+	{
+		CancelComputation();
+	}
 	_simBox = simBox;
 }
 
+void Host::ContinueComputation()
+{
+	_computationContinued = true;
+}
+
 auto Host::ComputationRequested() const -> bool
 {
 	return _computationRequested;
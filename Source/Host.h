@@ -1,8 +1,12 @@
 ﻿#pragma once
 
+#include <optional>
+
 #include <Saffron.h>
 
 #include "Common.h"
+#include "DoubleDouble.h"
+#include "Perturbation/BigReal.h"
 
 namespace Se
 {
@@ -11,6 +15,7 @@ enum class HostType
 	Cpu,
 	GpuComputeShader,
 	GpuPixelShader,
+	CpuPerturbation,
 	Count
 };
 
@@ -18,8 +23,20 @@ struct SimBox
 {
 	Position TopLeft;
 	Position BottomRight;
+	// The same corners to double-double precision, TopLeft and BottomRight are them rounded
+	PrecisePosition PreciseTopLeft;
+	PrecisePosition PreciseBottomRight;
+	// The view as its centre and the distance between neighbouring pixels, exact at any depth.
+	// Pixel (x, y) of a width by height image lies at Center + (x - width / 2, y - height / 2) * Spacing.
+	// Boxes made from corners alone leave these zero.
+	BigReal CenterX;
+	BigReal CenterY;
+	ExtendedReal Spacing;
 
 	SimBox(const Position& topLeft, const Position& bottomRight);
+	SimBox(const PrecisePosition& topLeft, const PrecisePosition& bottomRight);
+	// Derives the corners of an image of the given size in pixels
+	SimBox(BigReal centerX, BigReal centerY, const ExtendedReal& spacing, const Position& size);
 
 	auto operator==(const SimBox& other) const -> bool;
 	auto operator!=(const SimBox& other) const -> bool;
@@ -48,6 +65,18 @@ public:
 
 	void SetComputeIterations(ulong computeIterations);
 
+	// Milliseconds of tiles a frame may take, what is left carries over to the next one. Zero
+	// waits for the whole image, hosts that compute it in one go ignore the budget.
+	auto FrameBudget() const -> double;
+	void SetFrameBudget(double milliseconds);
+	// Pixel to compute outwards from, the centre of the image when unset
+	auto Focus() const -> const std::optional<sf::Vector2f>&;
+	void SetFocus(std::optional<sf::Vector2f> focus);
+
+	// Stops an image still computing in the background and waits for it. Hosts that compute
+	// on the calling thread have nothing to cancel.
+	virtual void CancelComputation() {}
+
 	template <class HostType>
 	auto As() -> HostType&
 	{
@@ -72,14 +101,20 @@ protected:
 	virtual void RenderImage() = 0;
 	virtual void Resize(int width, int height) = 0;
 
+	// Calls ComputeImage again next frame without it counting as a new request
+	void ContinueComputation();
+
 private:
 	HostType _type;
 	bool _computationRequested = true;
+	bool _computationContinued = false;
 	bool _renderRequested = true;
 	bool _resizeRequsted = true;
 	std::string _name;
 	sf::Vector2f _desiredSize;
 	ulong _computeIterations = 64;
+	double _frameBudget = 0.0;
+	std::optional<sf::Vector2f> _focus;
 	struct SimBox _simBox;
 	int _simWidth = 0, _simHeight = 0;
 };
@@ -0,0 +1,198 @@
+﻿#pragma once
+
+#include "Kernels/EscapeTime.h"
+
+// Double-double escape time kernels, written against the Simd wrappers like EscapeTime.h and
+// under the same rule: only include it from the translation unit compiled for that instruction
+// set. Every value is an unevaluated sum Hi + Lo of two doubles, which resolves pixels down to
+// about 1e-30 without a reference orbit to set up or glitches to correct.
+
+namespace Se::Kernels
+{
+template <class Simd>
+struct DoubleDoubleVector
+{
+	typename Simd::Vector Hi;
+	typename Simd::Vector Lo;
+};
+
+// hi + lo == a + b exactly
+template <class Simd>
+auto TwoSum(typename Simd::Vector a, typename Simd::Vector b) -> DoubleDoubleVector<Simd>
+{
+	const auto sum = Simd::Add(a, b);
+	const auto b1 = Simd::Sub(sum, a);
+	const auto error = Simd::Add(Simd::Sub(a, Simd::Sub(sum, b1)), Simd::Sub(b, b1));
+	return {sum, error};
+}
+
+// Same, for |a| >= |b|
+template <class Simd>
+auto QuickTwoSum(typename Simd::Vector a, typename Simd::Vector b) -> DoubleDoubleVector<Simd>
+{
+	const auto sum = Simd::Add(a, b);
+	return {sum, Simd::Sub(b, Simd::Sub(sum, a))};
+}
+
+// Adds the low parts without their own rounding error. The result is good to a couple of ulps of
+// the larger operand, which is all an orbit of magnitude below 2 needs.
+template <class Simd>
+auto Add(const DoubleDoubleVector<Simd>& a, const DoubleDoubleVector<Simd>& b) -> DoubleDoubleVector<Simd>
+{
+	const auto sum = TwoSum<Simd>(a.Hi, b.Hi);
+	return QuickTwoSum<Simd>(sum.Hi, Simd::Add(sum.Lo, Simd::Add(a.Lo, b.Lo)));
+}
+
+template <class Simd>
+auto Sub(const DoubleDoubleVector<Simd>& a, const DoubleDoubleVector<Simd>& b) -> DoubleDoubleVector<Simd>
+{
+	const auto sum = TwoSum<Simd>(a.Hi, Simd::Sub(Simd::Zero(), b.Hi));
+	return QuickTwoSum<Simd>(sum.Hi, Simd::Add(sum.Lo, Simd::Sub(a.Lo, b.Lo)));
+}
+
+template <class Simd>
+auto Mul(const DoubleDoubleVector<Simd>& a, const DoubleDoubleVector<Simd>& b) -> DoubleDoubleVector<Simd>
+{
+	const auto product = Simd::Mul(a.Hi, b.Hi);
+	const auto error = Simd::MulError(a.Hi, b.Hi, product);
+	const auto cross = Simd::MulAdd(a.Hi, b.Lo, Simd::Mul(a.Lo, b.Hi));
+	return QuickTwoSum<Simd>(product, Simd::Add(error, cross));
+}
+
+template <class Simd>
+auto Square(const DoubleDoubleVector<Simd>& a) -> DoubleDoubleVector<Simd>
+{
+	const auto product = Simd::Mul(a.Hi, a.Hi);
+	const auto error = Simd::MulError(a.Hi, a.Hi, product);
+	const auto cross = Simd::Mul(Simd::Add(a.Hi, a.Hi), a.Lo);
+	return QuickTwoSum<Simd>(product, Simd::Add(error, cross));
+}
+
+// Real coordinates of the next group of a span, with SpanLanes' padding. The offset from X0 is
+// rounded once, to a fraction of a pixel.
+template <class Simd>
+auto DoubleDoubleLanes(const Span& span, int first, int& lanes) -> DoubleDoubleVector<Simd>
+{
+	lanes = span.Count - first < Simd::Width ? span.Count - first : Simd::Width;
+
+	alignas(64) typename Simd::Scalar offsets[Simd::Width];
+	for (int lane = 0; lane < Simd::Width; lane++)
+	{
+		offsets[lane] = static_cast<double>(first + lane) * span.XStep;
+	}
+	const auto sum = TwoSum<Simd>(Simd::Set1(span.X0), Simd::Load(offsets));
+	auto x = QuickTwoSum<Simd>(sum.Hi, Simd::Add(sum.Lo, Simd::Set1(span.X0Low)));
+
+	const auto padding = Simd::FromBits((1u << lanes) - 1u);
+	x.Hi = Simd::Select(padding, x.Hi, Simd::Set1(4.0));
+	x.Lo = Simd::Select(padding, x.Lo, Simd::Zero());
+	return x;
+}
+
+// Iterate in double-double. Escape and periodicity only look at the high parts, the low parts
+// cannot change either decision.
+template <class Simd>
+auto IterateDoubleDouble(DoubleDoubleVector<Simd> zr, DoubleDoubleVector<Simd> zi,
+                         const DoubleDoubleVector<Simd>& cr, const DoubleDoubleVector<Simd>& ci, const Span& span,
+                         Periodicity<Simd>& periodicity, SpanStats& stats) -> typename Simd::Vector
+{
+	const auto one = Simd::Set1(1.0);
+	const auto four = Simd::Set1(4.0);
+	const auto iterations = Simd::Set1(static_cast<double>(span.Iterations));
+
+	auto n = Simd::Zero();
+	periodicity.Reset(zr.Hi, zi.Hi);
+	while (true)
+	{
+		const auto zr2 = Square<Simd>(zr);
+		const auto zi2 = Square<Simd>(zi);
+		const auto magnitude = Simd::Add(zr2.Hi, zi2.Hi);
+
+		const auto product = Mul<Simd>(zr, zi);
+		zi = Add<Simd>({Simd::Add(product.Hi, product.Hi), Simd::Add(product.Lo, product.Lo)}, ci);
+		zr = Add<Simd>(Sub<Simd>(zr2, zi2), cr);
+
+		auto live = Simd::And(Simd::Less(magnitude, four), Simd::Less(n, iterations));
+		if (span.CheckPeriodicity)
+		{
+			live = periodicity.Check(zr.Hi, zi.Hi, n, live);
+		}
+		n = Simd::MaskedAdd(n, live, one);
+		stats.VectorIterations++;
+		if (Simd::Bits(live) == 0)
+		{
+			return n;
+		}
+	}
+}
+
+// No interior test, in double it cannot tell points this close to the boundary apart
+template <class Simd>
+void MandelbrotDoubleDouble(const Span& span, SpanStats& stats)
+{
+	const DoubleDoubleVector<Simd> zero = {Simd::Zero(), Simd::Zero()};
+	const auto ci = QuickTwoSum<Simd>(Simd::Set1(span.Y), Simd::Set1(span.YLow));
+
+	Periodicity<Simd> periodicity(span.PeriodicityTolerance, span.Iterations);
+	size_t stored = 0;
+
+	for (int i = 0; i < span.Count; i += Simd::Width)
+	{
+		int lanes;
+		const auto cr = DoubleDoubleLanes<Simd>(span, i, lanes);
+		const auto n = IterateDoubleDouble<Simd>(zero, zero, cr, ci, span, periodicity, stats);
+		stored += StoreLanes<Simd>(span, i, lanes, n);
+	}
+
+	stats.SavedIterations += periodicity.SavedIterations;
+	stats.LaneIterations += stored - periodicity.SavedIterations;
+}
+
+template <class Simd>
+void JuliaDoubleDouble(const Span& span, double cr, double ci, SpanStats& stats)
+{
+	const DoubleDoubleVector<Simd> crs = {Simd::Set1(cr), Simd::Zero()};
+	const DoubleDoubleVector<Simd> cis = {Simd::Set1(ci), Simd::Zero()};
+	const auto zi = QuickTwoSum<Simd>(Simd::Set1(span.Y), Simd::Set1(span.YLow));
+
+	Periodicity<Simd> periodicity(span.PeriodicityTolerance, span.Iterations);
+	size_t stored = 0;
+
+	for (int i = 0; i < span.Count; i += Simd::Width)
+	{
+		int lanes;
+		const auto zr = DoubleDoubleLanes<Simd>(span, i, lanes);
+		const auto n = IterateDoubleDouble<Simd>(zr, zi, crs, cis, span, periodicity, stats);
+		stored += StoreLanes<Simd>(span, i, lanes, n);
+	}
+
+	stats.SavedIterations += periodicity.SavedIterations;
+	stats.LaneIterations += stored - periodicity.SavedIterations;
+}
+
+// Double-double has no lane refilling, a batch of spans is computed one span after the other
+template <class Simd>
+void MandelbrotDoubleDoubleStream(const Span* spans, size_t count, SpanStats& stats)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		MandelbrotDoubleDouble<Simd>(spans[i], stats);
+	}
+}
+
+template <class Simd>
+void JuliaDoubleDoubleStream(const Span* spans, size_t count, double cr, double ci, SpanStats& stats)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		JuliaDoubleDouble<Simd>(spans[i], cr, ci, stats);
+	}
+}
+
+template <class Simd>
+auto DoubleDoubleFunctions() -> KernelFunctions
+{
+	return {Simd::Width, &MandelbrotDoubleDouble<Simd>, &JuliaDoubleDouble<Simd>, &MandelbrotDoubleDoubleStream<Simd>,
+	        &JuliaDoubleDoubleStream<Simd>};
+}
+}
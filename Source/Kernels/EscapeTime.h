@@ -0,0 +1,424 @@
+﻿#pragma once
+
+#include <bit>
+
+#include "Kernels/Kernels.h"
+
+// Escape time kernels written once against the Simd wrappers, in double and in float. Only
+// include this from the translation unit compiled for that instruction set, everything here is
+// a template of the wrapper so no instruction set specific code is shared between them.
+
+namespace Se::Kernels
+{
+// Brent-style cycle detection. The orbit point is saved at every power of two iterations and
+// a lane that comes back to it within the tolerance has settled into a cycle, so it never
+// escapes and is retired with the full iteration count.
+template <class Simd>
+class Periodicity
+{
+	using Vector = typename Simd::Vector;
+	using Scalar = typename Simd::Scalar;
+	using Mask = typename Simd::Mask;
+
+public:
+	Periodicity(double tolerance, int64_t iterations) :
+		_tolerance(Simd::Set1(tolerance)),
+		_iterations(Simd::Set1(static_cast<double>(iterations))),
+		_iterationCount(static_cast<double>(iterations))
+	{
+	}
+
+	void Reset(Vector zr, Vector zi)
+	{
+		_savedR = zr;
+		_savedI = zi;
+		_step = 0;
+		_checkpoint = 1;
+	}
+
+	// Retires the live lanes whose orbit repeated and returns the ones left
+	auto Check(Vector zr, Vector zi, Vector& n, Mask live) -> Mask
+	{
+		const Mask close = Simd::And(Simd::Less(Simd::Abs(Simd::Sub(zr, _savedR)), _tolerance),
+		                             Simd::Less(Simd::Abs(Simd::Sub(zi, _savedI)), _tolerance));
+		const Mask cycle = Simd::And(close, live);
+
+		const unsigned cycleBits = Simd::Bits(cycle);
+		if (cycleBits != 0)
+		{
+			alignas(64) Scalar counts[Simd::Width];
+			Simd::Store(counts, n);
+			for (int lane = 0; lane < Simd::Width; lane++)
+			{
+				if (cycleBits & (1u << lane))
+				{
+					SavedIterations += static_cast<size_t>(_iterationCount - counts[lane]);
+				}
+			}
+			n = Simd::Select(cycle, _iterations, n);
+			live = Simd::AndNot(live, cycle);
+		}
+
+		if (++_step == _checkpoint)
+		{
+			_savedR = zr;
+			_savedI = zi;
+			_checkpoint *= 2;
+		}
+		return live;
+	}
+
+	size_t SavedIterations = 0;
+
+private:
+	Vector _tolerance;
+	Vector _iterations;
+	double _iterationCount;
+
+	Vector _savedR = Simd::Zero();
+	Vector _savedI = Simd::Zero();
+	int64_t _step = 0;
+	int64_t _checkpoint = 1;
+};
+
+// Points in the main cardioid or the period-2 bulb of the Mandelbrot set never escape
+template <class Simd>
+auto InMainCardioidOrBulb(typename Simd::Vector cr, typename Simd::Vector ci) -> typename Simd::Mask
+{
+	const auto quarter = Simd::Set1(0.25);
+	const auto imagSquared = Simd::Mul(ci, ci);
+	const auto shifted = Simd::Sub(cr, quarter);
+	const auto q = Simd::MulAdd(shifted, shifted, imagSquared);
+	const auto cardioid = Simd::Less(Simd::Mul(q, Simd::Add(q, shifted)), Simd::Mul(imagSquared, quarter));
+
+	const auto bulbX = Simd::Add(cr, Simd::Set1(1.0));
+	const auto bulb = Simd::Less(Simd::MulAdd(bulbX, bulbX, imagSquared), Simd::Set1(1.0 / 16.0));
+
+	return Simd::Or(cardioid, bulb);
+}
+
+// Real coordinates of the next group of a span. Lanes past its end start at 4.0, outside the
+// escape radius, so they drop out after the first iteration and never hold the group back.
+template <class Simd>
+auto SpanLanes(const Span& span, int first, int& lanes) -> typename Simd::Vector
+{
+	lanes = span.Count - first < Simd::Width ? span.Count - first : Simd::Width;
+
+	alignas(64) typename Simd::Scalar x[Simd::Width];
+	for (int lane = 0; lane < Simd::Width; lane++)
+	{
+		const double value = lane < lanes ? span.X0 + static_cast<double>(first + lane) * span.XStep : 4.0;
+		x[lane] = static_cast<typename Simd::Scalar>(value);
+	}
+	return Simd::Load(x);
+}
+
+// Returns the sum of the stored counts
+template <class Simd>
+auto StoreLanes(const Span& span, int first, int lanes, typename Simd::Vector n) -> size_t
+{
+	alignas(64) typename Simd::Scalar counts[Simd::Width];
+	Simd::Store(counts, n);
+	int* output = span.Output + static_cast<ptrdiff_t>(first) * span.Stride;
+	size_t sum = 0;
+	for (int lane = 0; lane < lanes; lane++)
+	{
+		output[lane * span.Stride] = static_cast<int>(counts[lane]);
+		sum += static_cast<size_t>(counts[lane]);
+	}
+	return sum;
+}
+
+// Scalar form of InMainCardioidOrBulb, in the precision of the lanes so both agree
+template <class Simd>
+auto InMainCardioidOrBulb(typename Simd::Scalar cr, typename Simd::Scalar ci) -> bool
+{
+	using Scalar = typename Simd::Scalar;
+	const Scalar imagSquared = ci * ci;
+	const Scalar shifted = cr - Scalar(0.25);
+	const Scalar q = shifted * shifted + imagSquared;
+	const Scalar bulbX = cr + Scalar(1);
+	return q * (q + shifted) < imagSquared * Scalar(0.25) || bulbX * bulbX + imagSquared < Scalar(1.0 / 16.0);
+}
+
+// Iterates z = z^2 + c until every lane escaped, ran out of iterations or was found to cycle.
+// n counts the iterations each lane started inside the escape radius.
+template <class Simd>
+auto Iterate(typename Simd::Vector zr, typename Simd::Vector zi, typename Simd::Vector cr, typename Simd::Vector ci,
+             typename Simd::Vector n, const Span& span, Periodicity<Simd>& periodicity,
+             SpanStats& stats) -> typename Simd::Vector
+{
+	const auto one = Simd::Set1(1.0);
+	const auto four = Simd::Set1(4.0);
+	const auto iterations = Simd::Set1(static_cast<double>(span.Iterations));
+
+	periodicity.Reset(zr, zi);
+	while (true)
+	{
+		const auto zr2 = Simd::Mul(zr, zr);
+		const auto zi2 = Simd::Mul(zi, zi);
+		const auto magnitude = Simd::Add(zr2, zi2);
+
+		zi = Simd::MulAdd(Simd::Add(zr, zr), zi, ci);
+		zr = Simd::Add(Simd::Sub(zr2, zi2), cr);
+
+		auto live = Simd::And(Simd::Less(magnitude, four), Simd::Less(n, iterations));
+		if (span.CheckPeriodicity)
+		{
+			live = periodicity.Check(zr, zi, n, live);
+		}
+		n = Simd::MaskedAdd(n, live, one);
+		stats.VectorIterations++;
+		if (Simd::Bits(live) == 0)
+		{
+			return n;
+		}
+	}
+}
+
+template <class Simd>
+void MandelbrotSpan(const Span& span, SpanStats& stats)
+{
+	const auto ci = Simd::Set1(span.Y);
+	const auto iterations = Simd::Set1(static_cast<double>(span.Iterations));
+	constexpr unsigned allLanes = (1u << Simd::Width) - 1u;
+
+	Periodicity<Simd> periodicity(span.PeriodicityTolerance, span.Iterations);
+	size_t stored = 0, skipped = 0;
+
+	for (int i = 0; i < span.Count; i += Simd::Width)
+	{
+		int lanes;
+		const auto cr = SpanLanes<Simd>(span, i, lanes);
+
+		// Known interior points start out done
+		const auto interior = InMainCardioidOrBulb<Simd>(cr, ci);
+		const unsigned interiorBits = Simd::Bits(interior);
+		auto n = Simd::Select(interior, iterations, Simd::Zero());
+		for (unsigned bits = interiorBits; bits != 0; bits &= bits - 1)
+		{
+			skipped++;
+		}
+
+		if (interiorBits != allLanes)
+		{
+			n = Iterate<Simd>(Simd::Zero(), Simd::Zero(), cr, ci, n, span, periodicity, stats);
+		}
+		stored += StoreLanes<Simd>(span, i, lanes, n);
+	}
+
+	stats.SkippedPixels += skipped;
+	stats.SavedIterations += periodicity.SavedIterations;
+	stats.LaneIterations += stored - periodicity.SavedIterations - skipped * static_cast<size_t>(span.Iterations);
+}
+
+template <class Simd>
+void JuliaSpan(const Span& span, double cr, double ci, SpanStats& stats)
+{
+	const auto crs = Simd::Set1(cr);
+	const auto cis = Simd::Set1(ci);
+	const auto zi = Simd::Set1(span.Y);
+
+	Periodicity<Simd> periodicity(span.PeriodicityTolerance, span.Iterations);
+	size_t stored = 0;
+
+	for (int i = 0; i < span.Count; i += Simd::Width)
+	{
+		int lanes;
+		const auto zr = SpanLanes<Simd>(span, i, lanes);
+		const auto n = Iterate<Simd>(zr, zi, crs, cis, Simd::Zero(), span, periodicity, stats);
+		stored += StoreLanes<Simd>(span, i, lanes, n);
+	}
+
+	stats.SavedIterations += periodicity.SavedIterations;
+	stats.LaneIterations += stored - periodicity.SavedIterations;
+}
+
+// Every lane owns one pixel at a time and is refilled from the spans once that pixel escapes,
+// runs out of iterations or is found to cycle. All spans share the iteration count
+// and periodicity settings of the first. Periodicity works per lane here, the checkpoint is
+// compared against each lane's own iteration count.
+template <class Simd, bool IsJulia>
+void StreamSpans(const Span* spans, size_t spanCount, double juliaR, double juliaI, SpanStats& stats)
+{
+	using Scalar = typename Simd::Scalar;
+	constexpr int width = Simd::Width;
+	// Refilling costs about as much as a dozen iterations, so wait for half the lanes
+	constexpr int refillLanes = width > 2 ? width / 2 : 1;
+	if (spanCount == 0)
+	{
+		return;
+	}
+
+	const double iterationCount = static_cast<double>(spans[0].Iterations);
+	const bool checkPeriodicity = spans[0].CheckPeriodicity;
+	const auto one = Simd::Set1(1.0);
+	const auto four = Simd::Set1(4.0);
+	const auto iterations = Simd::Set1(iterationCount);
+	const auto tolerance = Simd::Set1(spans[0].PeriodicityTolerance);
+
+	// Starting values of the lanes being refilled, parked lanes get a full count so they
+	// never go live again
+	alignas(64) Scalar zrs[width], zis[width], crs[width], cis[width], ns[width];
+	int* outputs[width] = {};
+
+	size_t spanIndex = 0;
+	int pixelIndex = 0;
+	size_t stored = 0, saved = 0, skipped = 0, trips = 0;
+
+	const auto refill = [&](int lane) -> bool
+	{
+		while (spanIndex < spanCount)
+		{
+			const Span& span = spans[spanIndex];
+			if (pixelIndex >= span.Count)
+			{
+				spanIndex++;
+				pixelIndex = 0;
+				continue;
+			}
+
+			const double x = span.X0 + static_cast<double>(pixelIndex) * span.XStep;
+			int* output = span.Output + static_cast<ptrdiff_t>(pixelIndex) * span.Stride;
+			pixelIndex++;
+
+			if constexpr (IsJulia)
+			{
+				zrs[lane] = static_cast<Scalar>(x);
+				zis[lane] = static_cast<Scalar>(span.Y);
+				crs[lane] = static_cast<Scalar>(juliaR);
+				cis[lane] = static_cast<Scalar>(juliaI);
+			}
+			else
+			{
+				if (InMainCardioidOrBulb<Simd>(static_cast<Scalar>(x), static_cast<Scalar>(span.Y)))
+				{
+					*output = static_cast<int>(span.Iterations);
+					skipped++;
+					continue;
+				}
+				zrs[lane] = 0;
+				zis[lane] = 0;
+				crs[lane] = static_cast<Scalar>(x);
+				cis[lane] = static_cast<Scalar>(span.Y);
+			}
+			ns[lane] = 0;
+			outputs[lane] = output;
+			return true;
+		}
+
+		zrs[lane] = zis[lane] = crs[lane] = cis[lane] = 0;
+		ns[lane] = static_cast<Scalar>(iterationCount);
+		return false;
+	};
+
+	unsigned occupied = 0;
+	for (int lane = 0; lane < width; lane++)
+	{
+		if (refill(lane))
+		{
+			occupied |= 1u << lane;
+		}
+	}
+
+	auto zr = Simd::Load(zrs), zi = Simd::Load(zis), cr = Simd::Load(crs), ci = Simd::Load(cis);
+	auto n = Simd::Load(ns);
+	auto savedR = zr, savedI = zi, checkpoint = one;
+
+	while (occupied != 0)
+	{
+		// Iterate until enough lanes are done, finished lanes stay dead until then
+		unsigned retired;
+		do
+		{
+			const auto zr2 = Simd::Mul(zr, zr);
+			const auto zi2 = Simd::Mul(zi, zi);
+			const auto magnitude = Simd::Add(zr2, zi2);
+			zi = Simd::MulAdd(Simd::Add(zr, zr), zi, ci);
+			zr = Simd::Add(Simd::Sub(zr2, zi2), cr);
+
+			auto live = Simd::And(Simd::Less(magnitude, four), Simd::Less(n, iterations));
+			if (checkPeriodicity)
+			{
+				const auto close = Simd::And(Simd::Less(Simd::Abs(Simd::Sub(zr, savedR)), tolerance),
+				                             Simd::Less(Simd::Abs(Simd::Sub(zi, savedI)), tolerance));
+				const auto cycle = Simd::And(close, live);
+				const unsigned cycleBits = Simd::Bits(cycle);
+				if (cycleBits != 0)
+				{
+					alignas(64) Scalar counts[width];
+					Simd::Store(counts, n);
+					for (int lane = 0; lane < width; lane++)
+					{
+						if (cycleBits & (1u << lane))
+						{
+							saved += static_cast<size_t>(iterationCount - counts[lane]);
+						}
+					}
+					n = Simd::Select(cycle, iterations, n);
+					live = Simd::AndNot(live, cycle);
+				}
+			}
+			n = Simd::MaskedAdd(n, live, one);
+			if (checkPeriodicity)
+			{
+				const auto reached = Simd::And(Simd::Equal(n, checkpoint), live);
+				savedR = Simd::Select(reached, zr, savedR);
+				savedI = Simd::Select(reached, zi, savedI);
+				checkpoint = Simd::Select(reached, Simd::Add(checkpoint, checkpoint), checkpoint);
+			}
+			trips++;
+
+			retired = occupied & ~Simd::Bits(live);
+		}
+		while (retired == 0 || (retired != occupied && std::popcount(retired) < refillLanes));
+
+		alignas(64) Scalar counts[width];
+		Simd::Store(counts, n);
+		for (unsigned bits = retired; bits != 0; bits &= bits - 1)
+		{
+			const int lane = std::countr_zero(bits);
+			*outputs[lane] = static_cast<int>(counts[lane]);
+			stored += static_cast<size_t>(counts[lane]);
+			if (!refill(lane))
+			{
+				occupied &= ~(1u << lane);
+			}
+		}
+
+		// Only the retired lanes were rewritten, the others keep their registers
+		const auto refilled = Simd::FromBits(retired);
+		zr = Simd::Select(refilled, Simd::Load(zrs), zr);
+		zi = Simd::Select(refilled, Simd::Load(zis), zi);
+		cr = Simd::Select(refilled, Simd::Load(crs), cr);
+		ci = Simd::Select(refilled, Simd::Load(cis), ci);
+		n = Simd::Select(refilled, Simd::Load(ns), n);
+		savedR = Simd::Select(refilled, zr, savedR);
+		savedI = Simd::Select(refilled, zi, savedI);
+		checkpoint = Simd::Select(refilled, one, checkpoint);
+	}
+
+	stats.VectorIterations += trips;
+	stats.SkippedPixels += skipped;
+	stats.SavedIterations += saved;
+	stats.LaneIterations += stored - saved;
+}
+
+template <class Simd>
+void MandelbrotStream(const Span* spans, size_t count, SpanStats& stats)
+{
+	StreamSpans<Simd, false>(spans, count, 0.0, 0.0, stats);
+}
+
+template <class Simd>
+void JuliaStream(const Span* spans, size_t count, double cr, double ci, SpanStats& stats)
+{
+	StreamSpans<Simd, true>(spans, count, cr, ci, stats);
+}
+
+template <class Simd>
+auto Functions() -> KernelFunctions
+{
+	return {Simd::Width, &MandelbrotSpan<Simd>, &JuliaSpan<Simd>, &MandelbrotStream<Simd>, &JuliaStream<Simd>};
+}
+}
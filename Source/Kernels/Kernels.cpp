@@ -0,0 +1,130 @@
+﻿#include "Kernels/Kernels.h"
+
+#include <array>
+#include <atomic>
+
+#if defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace Se::Kernels
+{
+// Defined in the translation unit built for each instruction set
+auto Sse2Kernels() -> KernelSet;
+auto Avx2Kernels() -> KernelSet;
+auto Avx512Kernels() -> KernelSet;
+
+namespace
+{
+auto Detect(Isa isa) -> bool
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	const bool fma = (info[2] & (1 << 12)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || maxLeaf < 7)
+	{
+		return isa == Isa::Sse2;
+	}
+
+	// The OS has to save the wider registers on context switches
+	const auto xcr0 = _xgetbv(0);
+	const bool ymmState = (xcr0 & 0x6) == 0x6;
+	const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+	__cpuidex(info, 7, 0);
+	const bool avx2 = (info[1] & (1 << 5)) != 0;
+	const bool avx512f = (info[1] & (1 << 16)) != 0;
+
+	switch (isa)
+	{
+	case Isa::Sse2: return true;
+	case Isa::Avx2: return ymmState && avx2 && fma;
+	case Isa::Avx512: return zmmState && avx512f;
+	default: return false;
+	}
+#else
+	__builtin_cpu_init();
+	switch (isa)
+	{
+	case Isa::Sse2: return true;
+	case Isa::Avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	case Isa::Avx512: return __builtin_cpu_supports("avx512f");
+	default: return false;
+	}
+#endif
+}
+
+auto KernelSets() -> const std::array<KernelSet, static_cast<size_t>(Isa::Count)>&
+{
+	static const std::array sets = {Sse2Kernels(), Avx2Kernels(), Avx512Kernels()};
+	return sets;
+}
+
+auto ActiveSet() -> std::atomic<const KernelSet*>&
+{
+	static std::atomic active = &Get(BestSupported());
+	return active;
+}
+}
+
+auto IsaName(Isa isa) -> const char*
+{
+	switch (isa)
+	{
+	case Isa::Sse2: return "SSE2";
+	case Isa::Avx2: return "AVX2";
+	case Isa::Avx512: return "AVX-512";
+	default: return "Unknown";
+	}
+}
+
+auto PrecisionName(Precision precision) -> const char*
+{
+	switch (precision)
+	{
+	case Precision::Float: return "32-bit";
+	case Precision::Double: return "64-bit";
+	case Precision::DoubleDouble: return "Double-double";
+	case Precision::Perturbation: return "Perturbation";
+	default: return "Unknown";
+	}
+}
+
+auto Supported(Isa isa) -> bool
+{
+	static const std::array supported = {Detect(Isa::Sse2), Detect(Isa::Avx2), Detect(Isa::Avx512)};
+	return supported[static_cast<size_t>(isa)];
+}
+
+auto BestSupported() -> Isa
+{
+	if (Supported(Isa::Avx512)) return Isa::Avx512;
+	if (Supported(Isa::Avx2)) return Isa::Avx2;
+	return Isa::Sse2;
+}
+
+auto Active() -> const KernelSet&
+{
+	return *ActiveSet().load(std::memory_order_relaxed);
+}
+
+void SetActive(Isa isa)
+{
+	if (Supported(isa))
+	{
+		ActiveSet().store(&Get(isa), std::memory_order_relaxed);
+	}
+}
+
+auto Get(Isa isa) -> const KernelSet&
+{
+	return KernelSets()[static_cast<size_t>(isa)];
+}
+}
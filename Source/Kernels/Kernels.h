@@ -0,0 +1,158 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Se::Kernels
+{
+enum class Isa
+{
+	Sse2,
+	Avx2,
+	Avx512,
+	Count
+};
+
+// Float kernels have twice the lanes but only hold about seven significant digits. Double-double
+// kernels keep about 32 digits in pairs of doubles, at roughly ten times the cost of double.
+// Perturbation iterates double offsets from a reference orbit, only its host can pick it.
+enum class Precision
+{
+	Float,
+	Double,
+	DoubleDouble,
+	Perturbation,
+	Count
+};
+
+// One run of pixels on a row, Count pixels XStep apart written Stride ints apart
+struct Span
+{
+	int* Output = nullptr;
+	int Count = 0;
+	int Stride = 1;
+
+	double X0 = 0.0;
+	double XStep = 0.0;
+	double Y = 0.0;
+	// Low parts of X0 and Y, only the double-double kernels read them
+	double X0Low = 0.0;
+	double YLow = 0.0;
+	// X0, XStep and Y are in units of 2^Exponent, only perturbation spans use it
+	int64_t Exponent = 0;
+
+	int64_t Iterations = 0;
+
+	bool CheckPeriodicity = false;
+	double PeriodicityTolerance = 0.0;
+};
+
+struct SpanStats
+{
+	size_t SavedIterations = 0;
+	size_t SkippedPixels = 0;
+
+	// Iterations done by live lanes, and loop trips of the whole vector. Their ratio over
+	// the vector width is the lane utilisation.
+	size_t LaneIterations = 0;
+	size_t VectorIterations = 0;
+
+	size_t GlitchedPixels = 0;
+	// Lane iterations skipped with the orbit's linear approximations
+	size_t ApproximatedIterations = 0;
+	// Lane iterations done on offsets too small for double
+	size_t ExtendedIterations = 0;
+};
+
+// Perturbation offsets below 2^MinPlainExponent are iterated with a separate exponent until they
+// grow past it. Above it double keeps every bit of them, with room to spare for the products.
+constexpr int64_t MinPlainExponent = -900;
+
+// Written by the perturbation kernel for pixels its reference orbit cannot resolve
+constexpr int GlitchedPixel = -1;
+
+// Bivariate linear approximation of a run of iterations: delta' = A delta + B dc, good while
+// |delta|^2 stays below RadiusSquared
+struct BlaStep
+{
+	double Ar, Ai;
+	double Br, Bi;
+	double RadiusSquared;
+};
+
+// Entry i of level j covers the 2^j iterations from orbit index 1 + i * 2^j
+struct BlaLevel
+{
+	const BlaStep* Steps = nullptr;
+	int64_t Count = 0;
+};
+
+// A reference orbit Z_0 ... Z_(Length - 1) rounded to double. A pixel whose |Z + delta|^2 drops
+// below GlitchBound has lost the digits that tell it apart from the reference.
+struct Orbit
+{
+	const double* Zr = nullptr;
+	const double* Zi = nullptr;
+	const double* GlitchBound = nullptr;
+	int64_t Length = 0;
+
+	// The reference point c rounded to double, enough to tell which pixels are known interior
+	double Cr = 0.0;
+	double Ci = 0.0;
+
+	// Optional, without levels every iteration is done
+	const BlaLevel* Bla = nullptr;
+	int BlaLevels = 0;
+};
+
+using MandelbrotKernel = void(*)(const Span& span, SpanStats& stats);
+using JuliaKernel = void(*)(const Span& span, double cr, double ci, SpanStats& stats);
+
+// Streaming variants take every span of a tile at once. A lane loads the next pixel as soon
+// as its current one retires instead of waiting for the slowest lane of its group.
+using MandelbrotStreamKernel = void(*)(const Span* spans, size_t count, SpanStats& stats);
+using JuliaStreamKernel = void(*)(const Span* spans, size_t count, double cr, double ci, SpanStats& stats);
+
+// Mandelbrot pixels as offsets from the orbit's reference point, the span's coordinates are the
+// offsets. Only exists in double, the offsets are tiny but need the full exponent range.
+using PerturbationKernel = void(*)(const Span& span, const Orbit& orbit, SpanStats& stats);
+
+struct KernelFunctions
+{
+	int Width;
+	MandelbrotKernel Mandelbrot;
+	JuliaKernel Julia;
+	MandelbrotStreamKernel MandelbrotStream;
+	JuliaStreamKernel JuliaStream;
+};
+
+struct KernelSet
+{
+	enum Isa Isa;
+	KernelFunctions Float;
+	KernelFunctions Double;
+	KernelFunctions DoubleDouble;
+	PerturbationKernel Perturbation;
+
+	auto For(enum Precision precision) const -> const KernelFunctions&
+	{
+		switch (precision)
+		{
+		case Precision::Float: return Float;
+		case Precision::DoubleDouble: return DoubleDouble;
+		default: return Double;
+		}
+	}
+};
+
+auto IsaName(enum Isa isa) -> const char*;
+auto PrecisionName(enum Precision precision) -> const char*;
+auto Supported(enum Isa isa) -> bool;
+auto BestSupported() -> enum Isa;
+
+// The kernels CPU workers call. Starts out as the widest the processor supports.
+auto Active() -> const KernelSet&;
+void SetActive(enum Isa isa);
+
+auto Get(enum Isa isa) -> const KernelSet&;
+}
@@ -0,0 +1,14 @@
+﻿// Built with AVX2 and FMA enabled, see premake5.lua
+#include "Kernels/SimdAvx2.h"
+#include "Kernels/EscapeTime.h"
+#include "Kernels/DoubleDouble.h"
+#include "Kernels/Perturbation.h"
+
+namespace Se::Kernels
+{
+auto Avx2Kernels() -> KernelSet
+{
+	return {Isa::Avx2, Functions<Avx2Float>(), Functions<Avx2>(), DoubleDoubleFunctions<Avx2>(),
+	        &PerturbationSpan<Avx2>};
+}
+}
@@ -0,0 +1,14 @@
+﻿// Built with AVX-512F enabled, see premake5.lua
+#include "Kernels/SimdAvx512.h"
+#include "Kernels/EscapeTime.h"
+#include "Kernels/DoubleDouble.h"
+#include "Kernels/Perturbation.h"
+
+namespace Se::Kernels
+{
+auto Avx512Kernels() -> KernelSet
+{
+	return {Isa::Avx512, Functions<Avx512Float>(), Functions<Avx512>(), DoubleDoubleFunctions<Avx512>(),
+	        &PerturbationSpan<Avx512>};
+}
+}
@@ -0,0 +1,14 @@
+﻿// Baseline x64, no extra compiler flags
+#include "Kernels/SimdSse2.h"
+#include "Kernels/EscapeTime.h"
+#include "Kernels/DoubleDouble.h"
+#include "Kernels/Perturbation.h"
+
+namespace Se::Kernels
+{
+auto Sse2Kernels() -> KernelSet
+{
+	return {Isa::Sse2, Functions<Sse2Float>(), Functions<Sse2>(), DoubleDoubleFunctions<Sse2>(),
+	        &PerturbationSpan<Sse2>};
+}
+}
@@ -0,0 +1,281 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#include "Kernels/EscapeTime.h"
+
+// Perturbation kernel, written against the Simd wrappers like EscapeTime.h and under the same
+// rule: only include it from the translation unit compiled for that instruction set.
+
+namespace Se::Kernels
+{
+// Skips ahead from orbit index k with the longest approximations every live lane is inside the
+// radius of, and returns the iterations skipped. Steps never go past index steps. The radii are
+// multiplied by radiusScale for offsets kept in other units.
+template <class Simd>
+auto Approximate(const Orbit& orbit, int64_t k, int64_t steps, typename Simd::Vector& dr,
+                 typename Simd::Vector& di, typename Simd::Vector dcr, typename Simd::Vector dci,
+                 typename Simd::Mask live, double radiusScale = 1.0) -> int64_t
+{
+	const int64_t start = k;
+
+	// Level j only has entries at indices 1 + i * 2^j, the single steps are not worth it
+	while ((k - 1) % 2 == 0)
+	{
+		const auto magnitude = Simd::MulAdd(dr, dr, Simd::Mul(di, di));
+		const auto valid = [&](int j)
+		{
+			const int64_t index = (k - 1) >> j;
+			if (index >= orbit.Bla[j].Count || k + (int64_t(1) << j) > steps)
+			{
+				return false;
+			}
+			const auto radius = Simd::Set1(orbit.Bla[j].Steps[index].RadiusSquared * radiusScale);
+			return Simd::Bits(Simd::AndNot(live, Simd::Less(magnitude, radius))) == 0;
+		};
+
+		// A merged run is never valid further out than its first half, so the first level that
+		// fails ends the search and a failing single pair costs one comparison
+		const int top = std::min(std::countr_zero(static_cast<uint64_t>(k - 1)), orbit.BlaLevels - 1);
+		int level = 0;
+		while (level < top && valid(level + 1))
+		{
+			level++;
+		}
+		if (level == 0)
+		{
+			break;
+		}
+
+		const auto& step = orbit.Bla[level].Steps[(k - 1) >> level];
+		const auto ar = Simd::Set1(step.Ar), ai = Simd::Set1(step.Ai);
+		const auto br = Simd::Set1(step.Br), bi = Simd::Set1(step.Bi);
+		const auto nextR = Simd::Add(Simd::Sub(Simd::Mul(ar, dr), Simd::Mul(ai, di)),
+		                             Simd::Sub(Simd::Mul(br, dcr), Simd::Mul(bi, dci)));
+		di = Simd::Add(Simd::MulAdd(ar, di, Simd::Mul(ai, dr)), Simd::MulAdd(br, dci, Simd::Mul(bi, dcr)));
+		dr = nextR;
+		k += int64_t(1) << level;
+	}
+	return k - start;
+}
+
+// Offsets too small for double are kept as w = delta / 2^scale, one scale for the whole vector
+// since neighbouring pixels have offsets of about the same size. Iterates
+// w' = (2Z + 2^scale w) w + dc / 2^scale and rescales as w grows, until 2^scale is back in
+// double's range. Nothing escapes or glitches in here, Z + delta is still Z. Returns the orbit
+// index reached, with delta and dc converted back to plain doubles.
+template <class Simd>
+auto IterateScaled(const Orbit& orbit, int64_t steps, int64_t exponent, typename Simd::Mask live,
+                   typename Simd::Vector& dcr, typename Simd::Vector& dci, typename Simd::Vector& dr,
+                   typename Simd::Vector& di, SpanStats& stats, size_t& approximated) -> int64_t
+{
+	// Past -1100 the power is zero either way, the clamp only keeps the int conversion safe
+	const auto power = [](int64_t e) { return std::ldexp(1.0, static_cast<int>(std::clamp<int64_t>(e, -1100, 1100))); };
+	const auto two = Simd::Set1(2.0);
+	const auto limit = Simd::Set1(power(64));
+	const int lanes = std::popcount(Simd::Bits(live));
+
+	int64_t scale = exponent;
+	auto wr = Simd::Zero(), wi = Simd::Zero();
+	int64_t k = 0;
+	while (k < steps && scale < MinPlainExponent)
+	{
+		if (k > 0 && orbit.BlaLevels > 0)
+		{
+			// |delta|^2 < r^2 is |w|^2 < r^2 / 4^scale
+			const int64_t skipped = Approximate<Simd>(orbit, k, steps, wr, wi, dcr, dci, live, power(-2 * scale));
+			approximated += static_cast<size_t>(skipped) * lanes;
+			k += skipped;
+			if (k == steps)
+			{
+				break;
+			}
+		}
+
+		// The quadratic term only matters once 2^scale is a number at all
+		const auto s = Simd::Set1(power(scale));
+		const auto tr = Simd::MulAdd(s, wr, Simd::Mul(two, Simd::Set1(orbit.Zr[k])));
+		const auto ti = Simd::MulAdd(s, wi, Simd::Mul(two, Simd::Set1(orbit.Zi[k])));
+		const auto nextR = Simd::Add(Simd::Sub(Simd::Mul(tr, wr), Simd::Mul(ti, wi)), dcr);
+		wi = Simd::Add(Simd::MulAdd(tr, wi, Simd::Mul(ti, wr)), dci);
+		wr = nextR;
+		k++;
+		stats.VectorIterations++;
+
+		// After a long approximation w may be too big to square, but not to store
+		const auto magnitude = Simd::MulAdd(wr, wr, Simd::Mul(wi, wi));
+		if (Simd::Bits(Simd::Less(limit, magnitude)) != 0)
+		{
+			alignas(64) typename Simd::Scalar parts[2 * Simd::Width];
+			Simd::Store(parts, wr);
+			Simd::Store(parts + Simd::Width, wi);
+			double largest = 0.0;
+			for (const double part : parts)
+			{
+				largest = std::max(largest, std::abs(part));
+			}
+			const int shift = std::ilogb(largest);
+			const auto factor = Simd::Set1(power(-shift));
+			wr = Simd::Mul(wr, factor);
+			wi = Simd::Mul(wi, factor);
+			dcr = Simd::Mul(dcr, factor);
+			dci = Simd::Mul(dci, factor);
+			scale += shift;
+		}
+	}
+	stats.ExtendedIterations += static_cast<size_t>(k) * lanes;
+
+	const auto back = Simd::Set1(power(scale));
+	dr = Simd::Mul(wr, back);
+	di = Simd::Mul(wi, back);
+	dcr = Simd::Mul(dcr, back);
+	dci = Simd::Mul(dci, back);
+	return k;
+}
+
+// True when every point within radius of c is in the main cardioid or the period-2 bulb. c is
+// inside the cardioid when one of the multipliers 1 +- sqrt(1 - 4c) of its fixed points is below
+// one in magnitude, and across the disc a multiplier moves by at most
+// radius * max |d/dc sqrt(1 - 4c)| = 2 radius / sqrt(|1 - 4c| - 4 radius).
+inline auto DiscInMainCardioidOrBulb(double cr, double ci, double radius) -> bool
+{
+	const std::complex<double> c(cr, ci);
+	if (std::abs(c + 1.0) + radius < 0.25)
+	{
+		return true;
+	}
+
+	const std::complex<double> root = std::sqrt(1.0 - 4.0 * c);
+	const double reach = std::abs(root) * std::abs(root) - 4.0 * radius;
+	return reach > 0.0 && std::abs(1.0 - root) + 2.0 * radius / std::sqrt(reach) < 1.0;
+}
+
+// Interior test for a whole perturbation span. Neighbouring pixels are closer together than
+// double can tell apart, so testing them one by one would flatten views near the boundary. The
+// span is only skipped when the disc around the reference that reaches its farthest pixel, plus
+// a margin far above the rounding of c and of the test itself, is inside.
+inline auto SpanInMainCardioidOrBulb(const Span& span, const Orbit& orbit) -> bool
+{
+	const double first = std::abs(span.X0), last = std::abs(span.X0 + (span.Count - 1) * span.XStep);
+	const double offset = std::hypot(std::max(first, last), span.Y);
+	const double reach = std::ldexp(offset, static_cast<int>(std::clamp<int64_t>(span.Exponent, -1100, 1100)));
+	return DiscInMainCardioidOrBulb(orbit.Cr, orbit.Ci, reach + 1e-12);
+}
+
+// Every lane follows the shared reference orbit Z with its own offset delta, starting at zero:
+// delta' = (2Z + delta) delta + dc. The pixel's orbit is Z + delta, so it escapes and counts
+// iterations like MandelbrotSpan does. A lane is glitched once |Z + delta| gets too small next to
+// |Z|, or when it outlives the reference, and is written as GlitchedPixel for another reference.
+// With approximation levels in the orbit, whole vectors skip runs of iterations at once while
+// all their live lanes are close enough to the reference. Spans with an exponent start out in
+// IterateScaled and only pay for it while their offsets are out of double's range. Spans that
+// lie well inside the main cardioid or the period-2 bulb are not iterated at all.
+template <class Simd>
+void PerturbationSpan(const Span& span, const Orbit& orbit, SpanStats& stats)
+{
+	if (SpanInMainCardioidOrBulb(span, orbit))
+	{
+		for (int i = 0; i < span.Count; i++)
+		{
+			span.Output[static_cast<ptrdiff_t>(i) * span.Stride] = static_cast<int>(span.Iterations);
+		}
+		stats.SkippedPixels += static_cast<size_t>(span.Count);
+		return;
+	}
+
+	const auto one = Simd::Set1(1.0);
+	const auto two = Simd::Set1(2.0);
+	const auto four = Simd::Set1(4.0);
+	const int64_t steps = span.Iterations < orbit.Length ? span.Iterations : orbit.Length;
+
+	size_t stored = 0, glitched = 0, approximated = 0;
+	for (int i = 0; i < span.Count; i += Simd::Width)
+	{
+		int lanes;
+		auto dcr = SpanLanes<Simd>(span, i, lanes);
+		auto dci = Simd::Set1(span.Y);
+
+		auto dr = Simd::Zero(), di = Simd::Zero(), n = Simd::Zero();
+		auto live = Simd::FromBits((1u << lanes) - 1u);
+		auto lost = Simd::FromBits(0);
+		int64_t k = 0;
+		if (span.Exponent < MinPlainExponent)
+		{
+			// The padding lanes would set the vector's scale. The last point is left to the loop
+			// below, it is where the reference escapes if it does.
+			dcr = Simd::Select(live, dcr, Simd::Zero());
+			k = IterateScaled<Simd>(orbit, steps - 1, span.Exponent, live, dcr, dci, dr, di, stats, approximated);
+			n = Simd::Select(live, Simd::Set1(static_cast<double>(k)), n);
+		}
+		for (; k < steps; k++)
+		{
+			if (k > 0 && orbit.BlaLevels > 0)
+			{
+				const int64_t skipped = Approximate<Simd>(orbit, k, steps, dr, di, dcr, dci, live);
+				if (skipped > 0)
+				{
+					n = Simd::MaskedAdd(n, live, Simd::Set1(static_cast<double>(skipped)));
+					approximated += static_cast<size_t>(skipped) * std::popcount(Simd::Bits(live));
+					k += skipped;
+					if (k == steps)
+					{
+						break;
+					}
+				}
+			}
+
+			const auto zr = Simd::Set1(orbit.Zr[k]);
+			const auto zi = Simd::Set1(orbit.Zi[k]);
+			const auto pr = Simd::Add(zr, dr);
+			const auto pi = Simd::Add(zi, di);
+			const auto magnitude = Simd::MulAdd(pr, pr, Simd::Mul(pi, pi));
+
+			const auto glitch = Simd::And(live, Simd::Less(magnitude, Simd::Set1(orbit.GlitchBound[k])));
+			lost = Simd::Or(lost, glitch);
+			live = Simd::AndNot(Simd::And(live, Simd::Less(magnitude, four)), glitch);
+			n = Simd::MaskedAdd(n, live, one);
+			stats.VectorIterations++;
+			if (Simd::Bits(live) == 0)
+			{
+				break;
+			}
+
+			const auto tr = Simd::MulAdd(two, zr, dr);
+			const auto ti = Simd::MulAdd(two, zi, di);
+			const auto nextR = Simd::Add(Simd::Sub(Simd::Mul(tr, dr), Simd::Mul(ti, di)), dcr);
+			di = Simd::Add(Simd::MulAdd(tr, di, Simd::Mul(ti, dr)), dci);
+			dr = nextR;
+		}
+
+		// The reference escaped before these pixels did
+		if (k == steps && steps < span.Iterations)
+		{
+			lost = Simd::Or(lost, live);
+		}
+
+		alignas(64) typename Simd::Scalar counts[Simd::Width];
+		Simd::Store(counts, n);
+		const unsigned lostBits = Simd::Bits(lost);
+		int* output = span.Output + static_cast<ptrdiff_t>(i) * span.Stride;
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			stored += static_cast<size_t>(counts[lane]);
+			if (lostBits & (1u << lane))
+			{
+				output[lane * span.Stride] = GlitchedPixel;
+				glitched++;
+			}
+			else
+			{
+				output[lane * span.Stride] = static_cast<int>(counts[lane]);
+			}
+		}
+	}
+
+	stats.LaneIterations += stored - approximated;
+	stats.GlitchedPixels += glitched;
+	stats.ApproximatedIterations += approximated;
+}
+}
@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include <immintrin.h>
+
+namespace Se::Kernels
+{
+// Four doubles per register, with fused multiply-add
+struct Avx2
+{
+	static constexpr int Width = 4;
+	using Scalar = double;
+	using Vector = __m256d;
+	using Mask = __m256d;
+
+	static auto Set1(double value) -> Vector { return _mm256_set1_pd(value); }
+	static auto Zero() -> Vector { return _mm256_setzero_pd(); }
+	static auto Load(const Scalar* from) -> Vector { return _mm256_loadu_pd(from); }
+	static void Store(Scalar* to, Vector value) { _mm256_storeu_pd(to, value); }
+
+	static auto Add(Vector a, Vector b) -> Vector { return _mm256_add_pd(a, b); }
+	static auto Sub(Vector a, Vector b) -> Vector { return _mm256_sub_pd(a, b); }
+	static auto Mul(Vector a, Vector b) -> Vector { return _mm256_mul_pd(a, b); }
+	static auto MulAdd(Vector a, Vector b, Vector c) -> Vector { return _mm256_fmadd_pd(a, b, c); }
+	static auto Abs(Vector a) -> Vector { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+	// a * b - product exactly, for product = a * b
+	static auto MulError(Vector a, Vector b, Vector product) -> Vector { return _mm256_fmsub_pd(a, b, product); }
+
+	static auto Less(Vector a, Vector b) -> Mask { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	static auto Equal(Vector a, Vector b) -> Mask { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+	static auto And(Mask a, Mask b) -> Mask { return _mm256_and_pd(a, b); }
+	static auto Or(Mask a, Mask b) -> Mask { return _mm256_or_pd(a, b); }
+	// a and not b
+	static auto AndNot(Mask a, Mask b) -> Mask { return _mm256_andnot_pd(b, a); }
+	static auto Bits(Mask mask) -> unsigned { return static_cast<unsigned>(_mm256_movemask_pd(mask)); }
+	static auto FromBits(unsigned bits) -> Mask
+	{
+		const __m256i lanes = _mm256_set_epi64x(8, 4, 2, 1);
+		const __m256i selected = _mm256_and_si256(_mm256_set1_epi64x(bits), lanes);
+		return _mm256_castsi256_pd(_mm256_cmpeq_epi64(selected, lanes));
+	}
+
+	static auto Select(Mask mask, Vector a, Vector b) -> Vector { return _mm256_blendv_pd(b, a, mask); }
+
+	static auto MaskedAdd(Vector a, Mask mask, Vector b) -> Vector
+	{
+		return _mm256_add_pd(a, _mm256_and_pd(mask, b));
+	}
+};
+
+// Eight floats per register, with fused multiply-add
+struct Avx2Float
+{
+	static constexpr int Width = 8;
+	using Scalar = float;
+	using Vector = __m256;
+	using Mask = __m256;
+
+	static auto Set1(double value) -> Vector { return _mm256_set1_ps(static_cast<float>(value)); }
+	static auto Zero() -> Vector { return _mm256_setzero_ps(); }
+	static auto Load(const Scalar* from) -> Vector { return _mm256_loadu_ps(from); }
+	static void Store(Scalar* to, Vector value) { _mm256_storeu_ps(to, value); }
+
+	static auto Add(Vector a, Vector b) -> Vector { return _mm256_add_ps(a, b); }
+	static auto Sub(Vector a, Vector b) -> Vector { return _mm256_sub_ps(a, b); }
+	static auto Mul(Vector a, Vector b) -> Vector { return _mm256_mul_ps(a, b); }
+	static auto MulAdd(Vector a, Vector b, Vector c) -> Vector { return _mm256_fmadd_ps(a, b, c); }
+	static auto Abs(Vector a) -> Vector { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+	static auto Less(Vector a, Vector b) -> Mask { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static auto Equal(Vector a, Vector b) -> Mask { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+	static auto And(Mask a, Mask b) -> Mask { return _mm256_and_ps(a, b); }
+	static auto Or(Mask a, Mask b) -> Mask { return _mm256_or_ps(a, b); }
+	// a and not b
+	static auto AndNot(Mask a, Mask b) -> Mask { return _mm256_andnot_ps(b, a); }
+	static auto Bits(Mask mask) -> unsigned { return static_cast<unsigned>(_mm256_movemask_ps(mask)); }
+	static auto FromBits(unsigned bits) -> Mask
+	{
+		const __m256i lanes = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+		const __m256i selected = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), lanes);
+		return _mm256_castsi256_ps(_mm256_cmpeq_epi32(selected, lanes));
+	}
+
+	static auto Select(Mask mask, Vector a, Vector b) -> Vector { return _mm256_blendv_ps(b, a, mask); }
+
+	static auto MaskedAdd(Vector a, Mask mask, Vector b) -> Vector
+	{
+		return _mm256_add_ps(a, _mm256_and_ps(mask, b));
+	}
+};
+}
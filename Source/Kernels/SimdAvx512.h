@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include <immintrin.h>
+
+namespace Se::Kernels
+{
+// Eight doubles per register, comparisons produce bit masks
+struct Avx512
+{
+	static constexpr int Width = 8;
+	using Scalar = double;
+	using Vector = __m512d;
+	using Mask = __mmask8;
+
+	static auto Set1(double value) -> Vector { return _mm512_set1_pd(value); }
+	static auto Zero() -> Vector { return _mm512_setzero_pd(); }
+	static auto Load(const Scalar* from) -> Vector { return _mm512_loadu_pd(from); }
+	static void Store(Scalar* to, Vector value) { _mm512_storeu_pd(to, value); }
+
+	static auto Add(Vector a, Vector b) -> Vector { return _mm512_add_pd(a, b); }
+	static auto Sub(Vector a, Vector b) -> Vector { return _mm512_sub_pd(a, b); }
+	static auto Mul(Vector a, Vector b) -> Vector { return _mm512_mul_pd(a, b); }
+	static auto MulAdd(Vector a, Vector b, Vector c) -> Vector { return _mm512_fmadd_pd(a, b, c); }
+	static auto Abs(Vector a) -> Vector { return _mm512_abs_pd(a); }
+	// a * b - product exactly, for product = a * b
+	static auto MulError(Vector a, Vector b, Vector product) -> Vector { return _mm512_fmsub_pd(a, b, product); }
+
+	static auto Less(Vector a, Vector b) -> Mask { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+	static auto Equal(Vector a, Vector b) -> Mask { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+	static auto And(Mask a, Mask b) -> Mask { return static_cast<Mask>(a & b); }
+	static auto Or(Mask a, Mask b) -> Mask { return static_cast<Mask>(a | b); }
+	// a and not b
+	static auto AndNot(Mask a, Mask b) -> Mask { return static_cast<Mask>(a & ~b); }
+	static auto Bits(Mask mask) -> unsigned { return mask; }
+	static auto FromBits(unsigned bits) -> Mask { return static_cast<Mask>(bits); }
+
+	static auto Select(Mask mask, Vector a, Vector b) -> Vector { return _mm512_mask_blend_pd(mask, b, a); }
+
+	static auto MaskedAdd(Vector a, Mask mask, Vector b) -> Vector { return _mm512_mask_add_pd(a, mask, a, b); }
+};
+
+// Sixteen floats per register
+struct Avx512Float
+{
+	static constexpr int Width = 16;
+	using Scalar = float;
+	using Vector = __m512;
+	using Mask = __mmask16;
+
+	static auto Set1(double value) -> Vector { return _mm512_set1_ps(static_cast<float>(value)); }
+	static auto Zero() -> Vector { return _mm512_setzero_ps(); }
+	static auto Load(const Scalar* from) -> Vector { return _mm512_loadu_ps(from); }
+	static void Store(Scalar* to, Vector value) { _mm512_storeu_ps(to, value); }
+
+	static auto Add(Vector a, Vector b) -> Vector { return _mm512_add_ps(a, b); }
+	static auto Sub(Vector a, Vector b) -> Vector { return _mm512_sub_ps(a, b); }
+	static auto Mul(Vector a, Vector b) -> Vector { return _mm512_mul_ps(a, b); }
+	static auto MulAdd(Vector a, Vector b, Vector c) -> Vector { return _mm512_fmadd_ps(a, b, c); }
+	static auto Abs(Vector a) -> Vector { return _mm512_abs_ps(a); }
+
+	static auto Less(Vector a, Vector b) -> Mask { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+	static auto Equal(Vector a, Vector b) -> Mask { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+	static auto And(Mask a, Mask b) -> Mask { return static_cast<Mask>(a & b); }
+	static auto Or(Mask a, Mask b) -> Mask { return static_cast<Mask>(a | b); }
+	// a and not b
+	static auto AndNot(Mask a, Mask b) -> Mask { return static_cast<Mask>(a & ~b); }
+	static auto Bits(Mask mask) -> unsigned { return mask; }
+	static auto FromBits(unsigned bits) -> Mask { return static_cast<Mask>(bits); }
+
+	static auto Select(Mask mask, Vector a, Vector b) -> Vector { return _mm512_mask_blend_ps(mask, b, a); }
+
+	static auto MaskedAdd(Vector a, Mask mask, Vector b) -> Vector { return _mm512_mask_add_ps(a, mask, a, b); }
+};
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <emmintrin.h>
+
+namespace Se::Kernels
+{
+// Two doubles per register, available on every x64 processor
+struct Sse2
+{
+	static constexpr int Width = 2;
+	using Scalar = double;
+	using Vector = __m128d;
+	using Mask = __m128d;
+
+	static auto Set1(double value) -> Vector { return _mm_set1_pd(value); }
+	static auto Zero() -> Vector { return _mm_setzero_pd(); }
+	static auto Load(const Scalar* from) -> Vector { return _mm_loadu_pd(from); }
+	static void Store(Scalar* to, Vector value) { _mm_storeu_pd(to, value); }
+
+	static auto Add(Vector a, Vector b) -> Vector { return _mm_add_pd(a, b); }
+	static auto Sub(Vector a, Vector b) -> Vector { return _mm_sub_pd(a, b); }
+	static auto Mul(Vector a, Vector b) -> Vector { return _mm_mul_pd(a, b); }
+	static auto MulAdd(Vector a, Vector b, Vector c) -> Vector { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+	static auto Abs(Vector a) -> Vector { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+	// a * b - product exactly, for product = a * b. Without FMA both are split into 26-bit
+	// halves whose products are exact.
+	static auto MulError(Vector a, Vector b, Vector product) -> Vector
+	{
+		const auto split = [](Vector v, Vector& high, Vector& low)
+		{
+			const Vector scaled = _mm_mul_pd(_mm_set1_pd(134217729.0), v);
+			high = _mm_sub_pd(scaled, _mm_sub_pd(scaled, v));
+			low = _mm_sub_pd(v, high);
+		};
+		Vector aHigh, aLow, bHigh, bLow;
+		split(a, aHigh, aLow);
+		split(b, bHigh, bLow);
+		Vector error = _mm_sub_pd(_mm_mul_pd(aHigh, bHigh), product);
+		error = _mm_add_pd(error, _mm_mul_pd(aHigh, bLow));
+		error = _mm_add_pd(error, _mm_mul_pd(aLow, bHigh));
+		return _mm_add_pd(error, _mm_mul_pd(aLow, bLow));
+	}
+
+	static auto Less(Vector a, Vector b) -> Mask { return _mm_cmplt_pd(a, b); }
+	static auto Equal(Vector a, Vector b) -> Mask { return _mm_cmpeq_pd(a, b); }
+	static auto And(Mask a, Mask b) -> Mask { return _mm_and_pd(a, b); }
+	static auto Or(Mask a, Mask b) -> Mask { return _mm_or_pd(a, b); }
+	// a and not b
+	static auto AndNot(Mask a, Mask b) -> Mask { return _mm_andnot_pd(b, a); }
+	static auto Bits(Mask mask) -> unsigned { return static_cast<unsigned>(_mm_movemask_pd(mask)); }
+	static auto FromBits(unsigned bits) -> Mask
+	{
+		return _mm_cmplt_pd(_mm_set_pd(bits & 2u ? -1.0 : 0.0, bits & 1u ? -1.0 : 0.0), _mm_setzero_pd());
+	}
+
+	static auto Select(Mask mask, Vector a, Vector b) -> Vector
+	{
+		return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+	}
+
+	static auto MaskedAdd(Vector a, Mask mask, Vector b) -> Vector { return _mm_add_pd(a, _mm_and_pd(mask, b)); }
+};
+
+// Four floats per register
+struct Sse2Float
+{
+	static constexpr int Width = 4;
+	using Scalar = float;
+	using Vector = __m128;
+	using Mask = __m128;
+
+	static auto Set1(double value) -> Vector { return _mm_set1_ps(static_cast<float>(value)); }
+	static auto Zero() -> Vector { return _mm_setzero_ps(); }
+	static auto Load(const Scalar* from) -> Vector { return _mm_loadu_ps(from); }
+	static void Store(Scalar* to, Vector value) { _mm_storeu_ps(to, value); }
+
+	static auto Add(Vector a, Vector b) -> Vector { return _mm_add_ps(a, b); }
+	static auto Sub(Vector a, Vector b) -> Vector { return _mm_sub_ps(a, b); }
+	static auto Mul(Vector a, Vector b) -> Vector { return _mm_mul_ps(a, b); }
+	static auto MulAdd(Vector a, Vector b, Vector c) -> Vector { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static auto Abs(Vector a) -> Vector { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+	static auto Less(Vector a, Vector b) -> Mask { return _mm_cmplt_ps(a, b); }
+	static auto Equal(Vector a, Vector b) -> Mask { return _mm_cmpeq_ps(a, b); }
+	static auto And(Mask a, Mask b) -> Mask { return _mm_and_ps(a, b); }
+	static auto Or(Mask a, Mask b) -> Mask { return _mm_or_ps(a, b); }
+	// a and not b
+	static auto AndNot(Mask a, Mask b) -> Mask { return _mm_andnot_ps(b, a); }
+	static auto Bits(Mask mask) -> unsigned { return static_cast<unsigned>(_mm_movemask_ps(mask)); }
+	static auto FromBits(unsigned bits) -> Mask
+	{
+		const __m128i lanes = _mm_set_epi32(8, 4, 2, 1);
+		const __m128i selected = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), lanes);
+		return _mm_castsi128_ps(_mm_cmpeq_epi32(selected, lanes));
+	}
+
+	static auto Select(Mask mask, Vector a, Vector b) -> Vector
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	static auto MaskedAdd(Vector a, Mask mask, Vector b) -> Vector { return _mm_add_ps(a, _mm_and_ps(mask, b)); }
+};
+}
@@ -11,11 +11,11 @@ PaletteManager::PaletteManager() :
 	// Create and initial upload
 	_texture.create(PaletteWidth, 1);
 
-	_palettes.emplace(PaletteType::Fiery, ImageStore::Get("Pals/fieryRec.png"));
-	_palettes.emplace(PaletteType::FieryAlt, ImageStore::Get("Pals/fiery.png"));
-	_palettes.emplace(PaletteType::UV, ImageStore::Get("Pals/uvRec.png"));
-	_palettes.emplace(PaletteType::GreyScale, ImageStore::Get("Pals/greyscaleRec.png"));
-	_palettes.emplace(PaletteType::Rainbow, ImageStore::Get("Pals/rainbowRec.png"));
+	for (int i = 0; i < static_cast<int>(PaletteType::Count); i++)
+	{
+		const auto type = static_cast<PaletteType>(i);
+		_palettes.emplace(type, ImageStore::Get(PaletteFile(type)));
+	}
 
 	// Assert each palette is at least PaletteWidth wide
 	for (const auto& image : _palettes | std::views::values)
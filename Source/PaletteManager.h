@@ -2,17 +2,10 @@
 
 #include <Saffron.h>
 
+#include "Palettes.h"
+
 namespace Se
 {
-enum class PaletteType
-{
-	Fiery,
-	FieryAlt,
-	UV,
-	GreyScale,
-	Rainbow
-};
-
 class PaletteManager : public Singleton<PaletteManager>
 {
 public:
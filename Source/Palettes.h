@@ -0,0 +1,43 @@
+﻿#pragma once
+
+// Kept free of the engine, the offline renderer colours with the same palettes as the window
+
+namespace Se
+{
+enum class PaletteType
+{
+	Fiery,
+	FieryAlt,
+	UV,
+	GreyScale,
+	Rainbow,
+	Count
+};
+
+// Image the palette is read from, relative to the texture assets
+constexpr auto PaletteFile(PaletteType type) -> const char*
+{
+	switch (type)
+	{
+	case PaletteType::Fiery: return "Pals/fieryRec.png";
+	case PaletteType::FieryAlt: return "Pals/fiery.png";
+	case PaletteType::UV: return "Pals/uvRec.png";
+	case PaletteType::GreyScale: return "Pals/greyscaleRec.png";
+	case PaletteType::Rainbow: return "Pals/rainbowRec.png";
+	default: return "";
+	}
+}
+
+constexpr auto PaletteName(PaletteType type) -> const char*
+{
+	switch (type)
+	{
+	case PaletteType::Fiery: return "Fiery";
+	case PaletteType::FieryAlt: return "Fiery Alt";
+	case PaletteType::UV: return "UV";
+	case PaletteType::GreyScale: return "Greyscale";
+	case PaletteType::Rainbow: return "Rainbow";
+	default: return "";
+	}
+}
+}
@@ -0,0 +1,243 @@
+﻿#include "Perturbation/BigReal.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Se
+{
+BigReal::BigReal(double value, int fractionLimbs) :
+	BigReal(ExtendedReal(value), fractionLimbs)
+{
+}
+
+BigReal::BigReal(const ExtendedReal& value, int fractionLimbs) :
+	_negative(value.Mantissa < 0.0),
+	_limbs(fractionLimbs + 1, 0)
+{
+	// value = bits * 2^(exponent - 53), bit b of the limbs stands for 2^(b - fraction bits)
+	const auto bits = static_cast<uint64_t>(std::ldexp(std::abs(value.Mantissa), 53));
+	const int64_t lowest = value.Exponent - 53 + static_cast<int64_t>(fractionLimbs) * LimbBits;
+	const int64_t total = static_cast<int64_t>(_limbs.size()) * LimbBits;
+	for (int bit = 0; bit < 53; bit++)
+	{
+		const int64_t position = lowest + bit;
+		if ((bits >> bit & 1u) != 0 && position >= 0 && position < total)
+		{
+			_limbs[position / LimbBits] |= 1u << (position % LimbBits);
+		}
+	}
+	if (IsZero())
+	{
+		_negative = false;
+	}
+}
+
+auto BigReal::LimbsFor(int fractionBits) -> int
+{
+	return std::max(1, (fractionBits + LimbBits - 1) / LimbBits);
+}
+
+auto BigReal::FractionLimbs() const -> int
+{
+	return static_cast<int>(_limbs.size()) - 1;
+}
+
+auto BigReal::Resized(int fractionLimbs) const -> BigReal
+{
+	const int cut = FractionLimbs() - fractionLimbs;
+	if (cut <= 0)
+	{
+		return Widened(fractionLimbs);
+	}
+	BigReal result;
+	result._limbs.assign(_limbs.begin() + cut, _limbs.end());
+	result._negative = _negative && !result.IsZero();
+	return result;
+}
+
+auto BigReal::ToDouble() const -> double
+{
+	// From the least significant limb up, so the rounding happens in the top limbs only
+	double value = 0.0;
+	const int fraction = FractionLimbs();
+	for (int i = 0; i < static_cast<int>(_limbs.size()); i++)
+	{
+		value += std::ldexp(static_cast<double>(_limbs[i]), (i - fraction) * LimbBits);
+	}
+	return _negative ? -value : value;
+}
+
+auto BigReal::ToExtended() const -> ExtendedReal
+{
+	// The top three limbs from the first non-zero one hold more than a double's mantissa
+	auto top = static_cast<int>(_limbs.size()) - 1;
+	while (top > 0 && _limbs[top] == 0)
+	{
+		top--;
+	}
+
+	double mantissa = 0.0;
+	for (int i = std::max(0, top - 2); i <= top; i++)
+	{
+		mantissa += std::ldexp(static_cast<double>(_limbs[i]), (i - top) * LimbBits);
+	}
+	const int64_t exponent = static_cast<int64_t>(top - FractionLimbs()) * LimbBits;
+	return {_negative ? -mantissa : mantissa, exponent};
+}
+
+auto BigReal::operator-() const -> BigReal
+{
+	BigReal result = *this;
+	result._negative = !_negative && !IsZero();
+	return result;
+}
+
+auto BigReal::operator+(const BigReal& other) const -> BigReal
+{
+	if (FractionLimbs() != other.FractionLimbs())
+	{
+		const int limbs = std::max(FractionLimbs(), other.FractionLimbs());
+		return Widened(limbs) + other.Widened(limbs);
+	}
+
+	if (_negative == other._negative)
+	{
+		return AddMagnitudes(*this, other, _negative);
+	}
+	if (CompareMagnitude(*this, other) >= 0)
+	{
+		return SubtractMagnitudes(*this, other, _negative);
+	}
+	return SubtractMagnitudes(other, *this, other._negative);
+}
+
+auto BigReal::operator-(const BigReal& other) const -> BigReal
+{
+	return *this + -other;
+}
+
+auto BigReal::operator*(const BigReal& other) const -> BigReal
+{
+	if (FractionLimbs() != other.FractionLimbs())
+	{
+		const int limbs = std::max(FractionLimbs(), other.FractionLimbs());
+		return Widened(limbs) * other.Widened(limbs);
+	}
+
+	// Schoolbook product, then drop the extra fraction limbs and anything above the integer limb.
+	// Reference orbits multiply millions of times, so the scratch space is kept around.
+	const size_t size = _limbs.size();
+	thread_local std::vector<uint32_t> product;
+	product.assign(2 * size, 0);
+	for (size_t i = 0; i < size; i++)
+	{
+		uint64_t carry = 0;
+		for (size_t j = 0; j < size; j++)
+		{
+			const uint64_t sum = static_cast<uint64_t>(_limbs[i]) * other._limbs[j] + product[i + j] + carry;
+			product[i + j] = static_cast<uint32_t>(sum);
+			carry = sum >> LimbBits;
+		}
+		product[i + size] = static_cast<uint32_t>(carry);
+	}
+
+	BigReal result;
+	result._limbs.assign(product.begin() + FractionLimbs(), product.begin() + FractionLimbs() + size);
+	result._negative = _negative != other._negative && !result.IsZero();
+	return result;
+}
+
+auto BigReal::operator==(const BigReal& other) const -> bool
+{
+	if (FractionLimbs() != other.FractionLimbs())
+	{
+		const int limbs = std::max(FractionLimbs(), other.FractionLimbs());
+		return Widened(limbs) == other.Widened(limbs);
+	}
+	return _negative == other._negative && _limbs == other._limbs;
+}
+
+auto BigReal::operator!=(const BigReal& other) const -> bool
+{
+	return !(*this == other);
+}
+
+auto BigReal::Widened(int fractionLimbs) const -> BigReal
+{
+	const int extra = fractionLimbs - FractionLimbs();
+	if (extra <= 0)
+	{
+		return *this;
+	}
+	BigReal result;
+	result._negative = _negative;
+	result._limbs.assign(extra, 0);
+	result._limbs.insert(result._limbs.end(), _limbs.begin(), _limbs.end());
+	return result;
+}
+
+auto BigReal::Hash() const -> uint64_t
+{
+	// FNV-1a over the sign and the limbs above the trailing zero ones, with their position
+	const auto first = std::find_if(_limbs.begin(), _limbs.end(), [](uint32_t limb) { return limb != 0; });
+	uint64_t hash = 0xcbf29ce484222325;
+	const auto mix = [&hash](uint64_t value)
+	{
+		hash = (hash ^ value) * 0x100000001b3;
+	};
+	mix(_negative && first != _limbs.end());
+	mix(static_cast<uint64_t>(_limbs.end() - first));
+	for (auto it = first; it != _limbs.end(); ++it)
+	{
+		mix(*it);
+	}
+	return hash;
+}
+
+auto BigReal::IsZero() const -> bool
+{
+	return std::all_of(_limbs.begin(), _limbs.end(), [](uint32_t limb) { return limb == 0; });
+}
+
+auto BigReal::CompareMagnitude(const BigReal& a, const BigReal& b) -> int
+{
+	for (size_t i = a._limbs.size(); i-- > 0;)
+	{
+		if (a._limbs[i] != b._limbs[i])
+		{
+			return a._limbs[i] < b._limbs[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
+auto BigReal::AddMagnitudes(const BigReal& a, const BigReal& b, bool negative) -> BigReal
+{
+	BigReal result;
+	result._limbs.resize(a._limbs.size());
+	uint64_t carry = 0;
+	for (size_t i = 0; i < a._limbs.size(); i++)
+	{
+		const uint64_t sum = static_cast<uint64_t>(a._limbs[i]) + b._limbs[i] + carry;
+		result._limbs[i] = static_cast<uint32_t>(sum);
+		carry = sum >> LimbBits;
+	}
+	result._negative = negative && !result.IsZero();
+	return result;
+}
+
+auto BigReal::SubtractMagnitudes(const BigReal& a, const BigReal& b, bool negative) -> BigReal
+{
+	BigReal result;
+	result._limbs.resize(a._limbs.size());
+	int64_t borrow = 0;
+	for (size_t i = 0; i < a._limbs.size(); i++)
+	{
+		const int64_t difference = static_cast<int64_t>(a._limbs[i]) - b._limbs[i] - borrow;
+		borrow = difference < 0 ? 1 : 0;
+		result._limbs[i] = static_cast<uint32_t>(difference + (borrow << LimbBits));
+	}
+	result._negative = negative && !result.IsZero();
+	return result;
+}
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Perturbation/ExtendedReal.h"
+
+namespace Se
+{
+// Sign and magnitude fixed point number for reference orbits. One 32-bit limb holds the integer
+// part and FractionLimbs() more hold the fraction, which is plenty for orbits that stay inside
+// the escape radius. Numbers of different lengths combine at the longer one.
+class BigReal
+{
+public:
+	BigReal() = default;
+	// Exact up to the fraction bits kept, the rest is cut off
+	BigReal(double value, int fractionLimbs);
+	BigReal(const ExtendedReal& value, int fractionLimbs);
+
+	static constexpr int LimbBits = 32;
+	// Limbs needed for this many bits after the binary point
+	static auto LimbsFor(int fractionBits) -> int;
+
+	auto FractionLimbs() const -> int;
+	// Padded with zeros or cut off to the given length
+	auto Resized(int fractionLimbs) const -> BigReal;
+	auto ToDouble() const -> double;
+	// Keeps the leading bits of numbers too small for ToDouble
+	auto ToExtended() const -> ExtendedReal;
+
+	auto operator-() const -> BigReal;
+	auto operator+(const BigReal& other) const -> BigReal;
+	auto operator-(const BigReal& other) const -> BigReal;
+	auto operator*(const BigReal& other) const -> BigReal;
+
+	auto operator==(const BigReal& other) const -> bool;
+	auto operator!=(const BigReal& other) const -> bool;
+	// Equal numbers hash the same whatever their length
+	auto Hash() const -> uint64_t;
+
+private:
+	auto Widened(int fractionLimbs) const -> BigReal;
+	auto IsZero() const -> bool;
+	static auto CompareMagnitude(const BigReal& a, const BigReal& b) -> int;
+	// Adds or subtracts magnitudes of equal length, |a| >= |b| when subtracting
+	static auto AddMagnitudes(const BigReal& a, const BigReal& b, bool negative) -> BigReal;
+	static auto SubtractMagnitudes(const BigReal& a, const BigReal& b, bool negative) -> BigReal;
+
+private:
+	bool _negative = false;
+	// Least significant first, the last limb is the integer part
+	std::vector<uint32_t> _limbs = {0};
+};
+}
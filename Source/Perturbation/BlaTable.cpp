@@ -0,0 +1,75 @@
+﻿#include "Perturbation/BlaTable.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Se
+{
+void BlaTable::Build(const ReferenceOrbit& orbit, double maxOffset)
+{
+	const auto start = std::chrono::steady_clock::now();
+	Clear();
+
+	// Merged from radii rather than their squares, the kernels compare squares
+	struct Run
+	{
+		double Ar, Ai, Br, Bi, Radius;
+	};
+
+	const auto view = orbit.View();
+	std::vector<Run> runs;
+	for (int64_t m = 1; m + 1 < view.Length; m++)
+	{
+		const double ar = 2.0 * view.Zr[m], ai = 2.0 * view.Zi[m];
+		runs.push_back({ar, ai, 1.0, 0.0, Epsilon * std::hypot(ar, ai)});
+	}
+
+	_steps.emplace_back();
+	while (runs.size() >= 2)
+	{
+		std::vector<Run> merged(runs.size() / 2);
+		for (size_t i = 0; i < merged.size(); i++)
+		{
+			const auto& x = runs[2 * i];
+			const auto& y = runs[2 * i + 1];
+			const double xScale = std::hypot(x.Ar, x.Ai);
+			const double yRadius = xScale > 0.0 ? (y.Radius - std::hypot(x.Br, x.Bi) * maxOffset) / xScale : x.Radius;
+			merged[i] = {
+				y.Ar * x.Ar - y.Ai * x.Ai, y.Ar * x.Ai + y.Ai * x.Ar,
+				y.Ar * x.Br - y.Ai * x.Bi + y.Br, y.Ar * x.Bi + y.Ai * x.Br + y.Bi,
+				std::min(x.Radius, std::max(0.0, yRadius))
+			};
+		}
+		runs = std::move(merged);
+
+		auto& level = _steps.emplace_back(runs.size());
+		for (size_t i = 0; i < runs.size(); i++)
+		{
+			level[i] = {runs[i].Ar, runs[i].Ai, runs[i].Br, runs[i].Bi, runs[i].Radius * runs[i].Radius};
+		}
+	}
+
+	for (const auto& level : _steps)
+	{
+		_levels.push_back({level.data(), static_cast<int64_t>(level.size())});
+	}
+	_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BlaTable::Clear()
+{
+	_steps.clear();
+	_levels.clear();
+}
+
+auto BlaTable::Levels() const -> const std::vector<Kernels::BlaLevel>&
+{
+	return _levels;
+}
+
+auto BlaTable::Seconds() const -> double
+{
+	return _seconds;
+}
+}
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "Kernels/Kernels.h"
+#include "Perturbation/ReferenceOrbit.h"
+
+namespace Se
+{
+// Bivariate linear approximations of a reference orbit. One iteration from Z_m is
+// delta' = 2 Z_m delta + dc as long as delta^2 is negligible next to it. Runs x and then y merge
+// into A = Ay Ax, B = Ay Bx + By, valid while y stays valid for every offset up to the largest dc.
+// Level j holds the merged runs of 2^j iterations.
+class BlaTable
+{
+public:
+	// delta^2 is negligible below this share of the linear term. Anything looser than double's
+	// rounding shows up as miscounted pixels near the boundary, the error adds up over long runs.
+	static constexpr double Epsilon = 1.0 / static_cast<double>(uint64_t(1) << 53);
+
+	// maxOffset bounds |dc| of every pixel that uses the orbit
+	void Build(const ReferenceOrbit& orbit, double maxOffset);
+	void Clear();
+
+	// For Kernels::Orbit, level 0 stays empty since single iterations are done exactly anyway
+	auto Levels() const -> const std::vector<Kernels::BlaLevel>&;
+	auto Seconds() const -> double;
+
+private:
+	std::vector<std::vector<Kernels::BlaStep>> _steps;
+	std::vector<Kernels::BlaLevel> _levels;
+	double _seconds = 0.0;
+};
+}
@@ -0,0 +1,85 @@
+﻿#include "Perturbation/ExtendedReal.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Se
+{
+namespace
+{
+// ldexp only takes an int, anything past this is zero or infinity anyway
+auto Ldexp(double value, int64_t exponent) -> double
+{
+	return std::ldexp(value, static_cast<int>(std::clamp<int64_t>(exponent, -4096, 4096)));
+}
+}
+
+ExtendedReal::ExtendedReal(double value) :
+	ExtendedReal(value, 0)
+{
+}
+
+ExtendedReal::ExtendedReal(double mantissa, int64_t exponent)
+{
+	int shift = 0;
+	Mantissa = std::frexp(mantissa, &shift);
+	Exponent = Mantissa == 0.0 ? 0 : exponent + shift;
+}
+
+auto ExtendedReal::ToDouble() const -> double
+{
+	return Ldexp(Mantissa, Exponent);
+}
+
+auto ExtendedReal::Scaled(int64_t exponent) const -> double
+{
+	return Ldexp(Mantissa, Exponent - exponent);
+}
+
+auto ExtendedReal::operator-() const -> ExtendedReal
+{
+	ExtendedReal result = *this;
+	result.Mantissa = -Mantissa;
+	return result;
+}
+
+auto ExtendedReal::operator+(const ExtendedReal& other) const -> ExtendedReal
+{
+	if (Mantissa == 0.0)
+	{
+		return other;
+	}
+	if (other.Mantissa == 0.0)
+	{
+		return *this;
+	}
+	// Line up on the larger exponent, the smaller one drops out once it is past the mantissa
+	const int64_t exponent = std::max(Exponent, other.Exponent);
+	return {Ldexp(Mantissa, Exponent - exponent) + Ldexp(other.Mantissa, other.Exponent - exponent), exponent};
+}
+
+auto ExtendedReal::operator-(const ExtendedReal& other) const -> ExtendedReal
+{
+	return *this + -other;
+}
+
+auto ExtendedReal::operator*(const ExtendedReal& other) const -> ExtendedReal
+{
+	return {Mantissa * other.Mantissa, Exponent + other.Exponent};
+}
+
+auto ExtendedReal::operator<(const ExtendedReal& other) const -> bool
+{
+	return (*this - other).Mantissa < 0.0;
+}
+
+auto ExtendedReal::operator==(const ExtendedReal& other) const -> bool
+{
+	return Mantissa == other.Mantissa && Exponent == other.Exponent;
+}
+
+auto ExtendedReal::operator!=(const ExtendedReal& other) const -> bool
+{
+	return !(*this == other);
+}
+}
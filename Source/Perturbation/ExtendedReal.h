@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include <cstdint>
+
+namespace Se
+{
+// A double mantissa with its own exponent, Mantissa * 2^Exponent with 0.5 <= |Mantissa| < 1 or
+// zero. For pixel spacings and offsets far below the smallest double.
+struct ExtendedReal
+{
+	double Mantissa = 0.0;
+	int64_t Exponent = 0;
+
+	ExtendedReal() = default;
+	explicit ExtendedReal(double value);
+	ExtendedReal(double mantissa, int64_t exponent);
+
+	// Zero or infinity outside of double's range
+	auto ToDouble() const -> double;
+	// The value in units of 2^exponent
+	auto Scaled(int64_t exponent) const -> double;
+
+	auto operator-() const -> ExtendedReal;
+	auto operator+(const ExtendedReal& other) const -> ExtendedReal;
+	auto operator-(const ExtendedReal& other) const -> ExtendedReal;
+	auto operator*(const ExtendedReal& other) const -> ExtendedReal;
+	auto operator<(const ExtendedReal& other) const -> bool;
+	auto operator==(const ExtendedReal& other) const -> bool;
+	auto operator!=(const ExtendedReal& other) const -> bool;
+};
+}
@@ -0,0 +1,80 @@
+﻿#include "Perturbation/ReferenceOrbit.h"
+
+#include <chrono>
+
+namespace Se
+{
+void ReferenceOrbit::Compute(const BigReal& cr, const BigReal& ci, size_t iterations,
+                             const std::function<bool()>& cancelled)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	_cr = cr;
+	_ci = ci;
+	_iterations = iterations;
+	_zr.clear();
+	_zi.clear();
+	_glitchBound.clear();
+
+	// The escaping point is stored as well, pixels may still be inside when the reference leaves
+	BigReal zr(0.0, cr.FractionLimbs()), zi(0.0, ci.FractionLimbs());
+	for (size_t n = 0; n < iterations; n++)
+	{
+		const double r = zr.ToDouble();
+		const double i = zi.ToDouble();
+		const double magnitude = r * r + i * i;
+		_zr.push_back(r);
+		_zi.push_back(i);
+		_glitchBound.push_back(GlitchTolerance * GlitchTolerance * magnitude);
+		if (magnitude >= 4.0)
+		{
+			break;
+		}
+		if (cancelled && n % 4096 == 4095 && cancelled())
+		{
+			_iterations = 0;
+			_zr.clear();
+			_zi.clear();
+			_glitchBound.clear();
+			break;
+		}
+
+		const auto cross = zr * zi;
+		zr = zr * zr - zi * zi + cr;
+		zi = cross + cross + ci;
+	}
+
+	_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+auto ReferenceOrbit::Cr() const -> const BigReal&
+{
+	return _cr;
+}
+
+auto ReferenceOrbit::Ci() const -> const BigReal&
+{
+	return _ci;
+}
+
+auto ReferenceOrbit::Iterations() const -> size_t
+{
+	return _iterations;
+}
+
+auto ReferenceOrbit::Length() const -> size_t
+{
+	return _zr.size();
+}
+
+auto ReferenceOrbit::Seconds() const -> double
+{
+	return _seconds;
+}
+
+auto ReferenceOrbit::View() const -> Kernels::Orbit
+{
+	return {_zr.data(), _zi.data(), _glitchBound.data(), static_cast<int64_t>(_zr.size()), _cr.ToDouble(),
+	        _ci.ToDouble()};
+}
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Kernels/Kernels.h"
+#include "Perturbation/BigReal.h"
+
+namespace Se
+{
+// The Mandelbrot orbit of one point, iterated at full precision and kept rounded to double for
+// the perturbation kernels
+class ReferenceOrbit
+{
+public:
+	// A pixel is glitched once |Z + delta| falls below this share of |Z|
+	static constexpr double GlitchTolerance = 1e-3;
+
+	// Gives up with an empty orbit once cancelled returns true, which is asked every few
+	// thousand iterations
+	void Compute(const BigReal& cr, const BigReal& ci, size_t iterations,
+	             const std::function<bool()>& cancelled = {});
+
+	auto Cr() const -> const BigReal&;
+	auto Ci() const -> const BigReal&;
+	auto Iterations() const -> size_t;
+	// Stored points, fewer than the iterations when the reference escaped
+	auto Length() const -> size_t;
+	auto Seconds() const -> double;
+
+	// Valid until the next Compute
+	auto View() const -> Kernels::Orbit;
+
+private:
+	BigReal _cr, _ci;
+	size_t _iterations = 0;
+	double _seconds = 0.0;
+
+	std::vector<double> _zr;
+	std::vector<double> _zi;
+	std::vector<double> _glitchBound;
+};
+}
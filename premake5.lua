@@ -25,6 +25,36 @@ workspace "Saffron"
 
 local SaffronEngine2D = require("ThirdParty.SaffronEngine2D.premake5")
 
+-- Each CPU kernel instruction set gets its own translation unit, picked at runtime with CPUID
+local function KernelBuildOptions()
+    filter { "files:Source/Kernels/KernelsAvx2.cpp", "toolset:msc*" }
+        buildoptions { "/arch:AVX2" }
+
+    filter { "files:Source/Kernels/KernelsAvx2.cpp", "toolset:not msc*" }
+        buildoptions { "-mavx2", "-mfma" }
+
+    filter { "files:Source/Kernels/KernelsAvx512.cpp", "toolset:msc*" }
+        buildoptions { "/arch:AVX512" }
+
+    filter { "files:Source/Kernels/KernelsAvx512.cpp", "toolset:not msc*" }
+        buildoptions { "-mavx512f" }
+
+    filter {}
+end
+
+local function ConfigurationOptions()
+    filter "configurations:Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        optimize "On"
+
+    filter "configurations:Dist"
+        optimize "On"
+
+    filter {}
+end
+
 project (ProjectName)
     kind "ConsoleApp"
     language "C++"
@@ -74,11 +104,55 @@ project (ProjectName)
     CopyAssetsToOutput("Release", from, OutBin  .. AstFol, PrjLoc .. AstFol)
     CopyAssetsToOutput("Dist", from, OutBinDist  .. AstFol, PrjLoc .. AstFol)
 
-    filter "configurations:Debug"
-        symbols "On"
+    KernelBuildOptions()
+    ConfigurationOptions()
 
-    filter "configurations:Release"
-        optimize "On"
+-- Renders to image files without a window or GL context, for headless machines. Only builds the
+-- engine-free parts of the tree and reads the palettes straight from Assets/.
+project (ProjectName .. "Offline")
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+	staticruntime "On"
+
+	objdir (OutObj)
+	location (OutLoc)
+
+    filter "configurations:Debug or Release"
+	    targetdir (OutBin)
 
     filter "configurations:Dist"
-        optimize "On"
+        targetdir (OutBinDist)
+
+    filter {}
+
+    files {
+        "Offline/**.h",
+        "Offline/**.cpp",
+        "Source/Palettes.h",
+        "Source/ComputePool.h",
+        "Source/ComputePool.cpp",
+        "Source/ComputeHosts/TileScheduler.h",
+        "Source/ComputeHosts/TileScheduler.cpp",
+        "Source/Kernels/**.h",
+        "Source/Kernels/**.cpp",
+    }
+
+    includedirs {
+        "Source",
+        "Offline",
+    }
+
+    -- zlib inflates the palette images and deflates PNG output. Linux has it as a system
+    -- library, elsewhere it has to be added to the project by hand for now.
+    filter "system:linux"
+        links { "z", "pthread" }
+
+    filter {}
+
+    CopyAssetsToOutput("Debug", from, OutBin .. AstFol, PrjLoc .. AstFol)
+    CopyAssetsToOutput("Release", from, OutBin  .. AstFol, PrjLoc .. AstFol)
+    CopyAssetsToOutput("Dist", from, OutBinDist  .. AstFol, PrjLoc .. AstFol)
+
+    KernelBuildOptions()
+    ConfigurationOptions()